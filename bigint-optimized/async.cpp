@@ -0,0 +1,49 @@
+#include "async.h"
+
+#include <utility>
+#include <vector>
+#include "limb_arithmetic.h"
+#include "number_theory.h"
+
+namespace {
+
+// Arguments cross to the computing thread as plain limbs: a copied
+// big_integer could share storage whose reference count is not atomic.
+struct argument {
+    explicit argument(big_integer const& a)
+        : limbs(a.num.data(), a.num.data() + a.num.size())
+        , sign(a.sign) {}
+
+    big_integer value() const {
+        return from_limbs(limbs, sign);
+    }
+
+    std::vector<uint32_t> limbs;
+    bool sign;
+};
+
+template <typename F>
+auto launch(cancellation_token const& token, F&& f) -> std::future<decltype(f())> {
+    return std::async(std::launch::async, [token, f] {
+        cancellation_scope scope(token);
+        check_cancelled();
+        return f();
+    });
+}
+
+}
+
+std::future<big_integer> async_mul(big_integer const& a, big_integer const& b, cancellation_token token) {
+    argument x(a), y(b);
+    return launch(token, [x, y] { return x.value() * y.value(); });
+}
+
+std::future<big_integer> async_pow(big_integer const& base, uint64_t exp, cancellation_token token) {
+    argument x(base);
+    return launch(token, [x, exp] { return pow(x.value(), exp); });
+}
+
+std::future<std::string> async_to_string(big_integer const& a, int base, cancellation_token token) {
+    argument x(a);
+    return launch(token, [x, base] { return to_string(x.value(), base); });
+}
@@ -0,0 +1,22 @@
+#ifndef BIGINT_ASYNC_H
+#define BIGINT_ASYNC_H
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include "big_integer.h"
+#include "parallel.h"
+
+// Long computations started on their own thread, which also takes part in
+// the shared pool's work for them. The arguments are copied up front, so
+// the caller may change or destroy its values at once. Cancelling the token
+// makes the computation stop at its next recursion step, and the future
+// then throws operation_cancelled.
+std::future<big_integer> async_mul(big_integer const& a, big_integer const& b,
+                                   cancellation_token token = cancellation_token());
+std::future<big_integer> async_pow(big_integer const& base, uint64_t exp,
+                                   cancellation_token token = cancellation_token());
+std::future<std::string> async_to_string(big_integer const& a, int base = 10,
+                                         cancellation_token token = cancellation_token());
+
+#endif //BIGINT_ASYNC_H
@@ -0,0 +1,132 @@
+#include "big_divisor.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "limb_arithmetic.h"
+#include "parallel.h"
+
+// Quotient limbs between checks for cancellation in long divisions.
+static const size_t CANCELLATION_INTERVAL = 256;
+
+big_divisor::big_divisor(big_integer const& divisor)
+    : d(divisor)
+    , norm(divisor.num.size())
+    , shift(0)
+    , inv(0) {
+    if (divisor == 0) {
+        throw std::invalid_argument("division by zero");
+    }
+    size_t m = norm.size();
+    shift = leading_zeros(divisor.num[m - 1]);
+    lshift(norm.data(), divisor.num.data(), m, shift);
+    inv = m == 1 ? invert_limb(norm[0]) : invert_pi1(norm[m - 1], norm[m - 2]);
+}
+
+big_integer big_divisor::div(big_integer const& a) const {
+    big_integer q;
+    divide(a, &q, nullptr);
+    return q;
+}
+
+big_integer big_divisor::mod(big_integer const& a) const {
+    big_integer r;
+    divide(a, nullptr, &r);
+    return r;
+}
+
+std::pair<big_integer, big_integer> big_divisor::divmod(big_integer const& a) const {
+    std::pair<big_integer, big_integer> res;
+    divide(a, &res.first, &res.second);
+    return res;
+}
+
+big_integer const& big_divisor::value() const {
+    return d;
+}
+
+void big_divisor::divide(big_integer const& a, big_integer* q, big_integer* r) const {
+    size_t m = norm.size();
+    size_t n = a.num.size();
+    if (n < m || (n == m && cmp_n(a.num.data(), d.num.data(), n) < 0)) {
+        if (q) {
+            *q = 0;
+        }
+        if (r) {
+            *r = a;
+        }
+        return;
+    }
+    std::vector<uint32_t> u(n + 1);
+    u[n] = lshift(u.data(), a.num.data(), n, shift);
+    std::vector<uint32_t> quot(n - m + 1);
+    if (m == 1) {
+        uint32_t rem = u[n];
+        for (size_t i = n; i > 0; i--) {
+            quot[i - 1] = div_2by1(rem, rem, u[i - 1], norm[0], inv);
+        }
+        u[0] = rem;
+    } else {
+        uint32_t d1 = norm[m - 1], d0 = norm[m - 2];
+        for (size_t j = n - m + 1; j > 0; j--) {
+            if (j % CANCELLATION_INTERVAL == 0) {
+                check_cancelled();
+            }
+            uint32_t* window = u.data() + j - 1;
+            uint32_t cur = UINT32_MAX;
+            if (window[m] != d1 || window[m - 1] != d0) {
+                cur = div_3by2(window[m], window[m - 1], window[m - 2], d1, d0, inv);
+            }
+            int64_t top = static_cast<int64_t>(window[m]) - submul_1(window, norm.data(), m, cur);
+            while (top < 0) {
+                top += add_n(window, window, norm.data(), m);
+                cur--;
+            }
+            window[m] = static_cast<uint32_t>(top);
+            quot[j - 1] = cur;
+        }
+    }
+    if (q) {
+        *q = from_limbs(std::move(quot), a.sign != d.sign);
+    }
+    if (r) {
+        u.resize(m);
+        rshift(u.data(), u.data(), m, shift);
+        *r = from_limbs(std::move(u), a.sign);
+    }
+}
+
+uint64_t divmod_small(big_integer& a, uint64_t d) {
+    if (d == 0) {
+        throw std::invalid_argument("division by zero");
+    }
+    size_t n = a.num.size();
+    uint32_t* limbs = a.num.data();
+    uint64_t r = d >> 32 == 0 ? divrem_1(limbs, limbs, n, static_cast<uint32_t>(d)) : divrem_2(limbs, limbs, n, d);
+    a.normalize();
+    return r;
+}
+
+big_integer divexact(big_integer const& a, big_integer const& b) {
+    if (b == 0) {
+        throw std::invalid_argument("division by zero");
+    }
+    size_t an = a.num.size(), bn = b.num.size();
+    if (an < bn) {
+        return 0;
+    }
+    uint32_t const* ap = a.num.data();
+    uint32_t const* bp = b.num.data();
+    size_t zeros = 0;
+    while (bp[zeros] == 0) {
+        zeros++;
+    }
+    uint32_t shift = __builtin_ctz(bp[zeros]);
+    size_t vn = bn - zeros, qn = an - bn + 1;
+    std::vector<uint32_t> v(vn), u(std::min(qn + 1, an - zeros));
+    rshift(v.data(), bp + zeros, vn, shift);
+    rshift(u.data(), ap + zeros, u.size(), shift);
+    std::vector<uint32_t> q(qn);
+    bdiv_q(q.data(), u.data(), qn, v.data(), vn);
+    return from_limbs(std::move(q), a.sign != b.sign);
+}
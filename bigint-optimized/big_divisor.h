@@ -0,0 +1,42 @@
+#ifndef BIGINT_BIG_DIVISOR_H
+#define BIGINT_BIG_DIVISOR_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "big_integer.h"
+
+// Divisor prepared once for many divisions: the magnitude is shifted so that
+// its top bit is set and the reciprocal of its top limbs is cached, so every
+// division only runs the quotient loop. Rounding matches operator/ and
+// operator%: the quotient is truncated, the remainder takes the dividend's sign.
+class big_divisor {
+public:
+    explicit big_divisor(big_integer const& d);
+
+    big_integer div(big_integer const& a) const;
+    big_integer mod(big_integer const& a) const;
+    std::pair<big_integer, big_integer> divmod(big_integer const& a) const;
+
+    big_integer const& value() const;
+
+private:
+    void divide(big_integer const& a, big_integer* q, big_integer* r) const;
+
+    big_integer d;
+    std::vector<uint32_t> norm;
+    uint32_t shift;
+    uint32_t inv;
+};
+
+// Divides a in place by d != 0, truncating, and returns |a| mod d (the
+// remainder of operator% has the dividend's sign). One pass over the limbs
+// multiplying by a reciprocal of d; nothing is allocated unless a is shared.
+uint64_t divmod_small(big_integer& a, uint64_t d);
+
+// a / b for b known to divide a; the result is unspecified otherwise. Common
+// factors of two are shifted out and the rest is Hensel division by the odd
+// part of b, which skips quotient estimation and correction.
+big_integer divexact(big_integer const& a, big_integer const& b);
+
+#endif //BIGINT_BIG_DIVISOR_H
@@ -1,4 +1,7 @@
 #include "big_integer.h"
+#include "big_divisor.h"
+#include "limb_arithmetic.h"
+#include "radix_conversion.h"
 
 #include <cstring>
 #include <stdexcept>
@@ -6,13 +9,14 @@
 #include <cstdint>
 #include <utility>
 #include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
 
 static const uint32_t SHIFT = 32;
-static const uint32_t HALF_SHIFT = SHIFT / 2;
-static const uint32_t HALF_BITS = (1ULL << 16ULL) - 1;
 
 big_integer::big_integer()
-    : num({0})
+    : num(0U)
     , sign(false) {}
 
 big_integer::big_integer(big_integer const& other)
@@ -24,16 +28,18 @@ big_integer& big_integer::operator=(big_integer const& other) = default;
 big_integer::~big_integer() = default;
 
 big_integer::big_integer(int a)
-    : num({static_cast<uint32_t>(std::abs(1ll * a))})
-    , sign(a < 0) {
-    normalize();
-}
+    : num(static_cast<uint32_t>(std::abs(1ll * a)))
+    , sign(a < 0) {}
 
 big_integer::big_integer(uint32_t a)
-    : num({a})
-    , sign(false) {
-    normalize();
-}
+    : num(a)
+    , sign(false) {}
+
+big_integer::big_integer(long a)
+    : big_integer(static_cast<long long>(a)) {}
+
+big_integer::big_integer(unsigned long a)
+    : big_integer(static_cast<unsigned long long>(a)) {}
 
 int addInt(uint32_t &a, uint32_t b) {
     uint32_t c = a;
@@ -47,6 +53,53 @@ int subInt(uint32_t &a, uint32_t b) {
     return b != 0 && a >= c;
 }
 
+// Values of at most two limbs sit in the inline buffer of num. When both
+// operands fit in an int64_t, +, -, *, / and % run on native words with
+// overflow-checked builtins and store the result back into the buffer; only
+// results that overflow fall through to the limb loops.
+static uint64_t low_word(big_integer const& a) {
+    return a.num[0] | (a.num.size() > 1 ? static_cast<uint64_t>(a.num[1]) << SHIFT : 0);
+}
+
+static bool word_to_int64(uint64_t mag, bool negative, int64_t& v) {
+    if (mag > static_cast<uint64_t>(INT64_MAX) + negative) {
+        return false;
+    }
+    v = static_cast<int64_t>(negative ? 0 - mag : mag);
+    return true;
+}
+
+static bool to_int64(big_integer const& a, int64_t& v) {
+    return a.num.size() <= 2 && word_to_int64(low_word(a), a.sign, v);
+}
+
+static big_integer& assign_word(big_integer& a, uint64_t mag, bool negative) {
+    uint32_t high = static_cast<uint32_t>(mag >> SHIFT);
+    a.num.resize(high != 0 ? 2 : 1);
+    a.num[0] = static_cast<uint32_t>(mag);
+    if (high != 0) {
+        a.num[1] = high;
+    }
+    a.sign = negative && mag != 0;
+    return a;
+}
+
+static big_integer& assign_int64(big_integer& a, int64_t v) {
+    return assign_word(a, v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v), v < 0);
+}
+
+big_integer::big_integer(long long a)
+    : num(0U)
+    , sign(false) {
+    assign_int64(*this, a);
+}
+
+big_integer::big_integer(unsigned long long a)
+    : num(0U)
+    , sign(false) {
+    assign_word(*this, a, false);
+}
+
 void big_integer::normalize() {
     while (num.size() > 1 && num.back() == 0) {
         num.pop_back();
@@ -56,37 +109,35 @@ void big_integer::normalize() {
     }
 }
 
-std::pair<uint32_t, uint32_t> mul(uint32_t n, uint32_t m) {
-    uint32_t a = n >> HALF_SHIFT, b = n & HALF_BITS,
-            c = m >> HALF_SHIFT, d = m & HALF_BITS;
-    uint32_t top = a * c, bot = b * d, bc = b * c, ad = a * d;
-    a = (bc >> HALF_SHIFT);
-    b = (bc & HALF_BITS) << HALF_SHIFT;
-    c = (ad >> HALF_SHIFT);
-    d = (ad & HALF_BITS) << HALF_SHIFT;
-    top += a + c;
-    if (bot + b < bot) {
-        top++;
+big_integer::big_integer(uint32_t const* limbs, size_t n, bool negative, std::shared_ptr<void const> owner)
+    : num(0U)
+    , sign(false) {
+    while (n > 0 && limbs[n - 1] == 0) {
+        n--;
     }
-    bot += b;
-    if (bot + d < bot) {
-        top++;
+    if (n <= 2) {
+        *this = from_limbs(std::vector<uint32_t>(limbs, limbs + n), negative);
+        return;
     }
-    bot += d;
-    return std::make_pair(top, bot);
+    num = shared_vector_small_object(limbs, n, std::move(owner));
+    sign = negative;
 }
 
-big_integer::big_integer(std::string const& str) : num({0}) {
-    big_integer res = 0;
-    for (size_t i = str[0] == '-'; i < str.size(); i++) {
-        res *= 10;
-        res += (int)(str[i] - '0');
+big_integer::big_integer(std::string const& str, int base)
+    : num(0U)
+    , sign(false) {
+    char const* end = str.data() + str.size();
+    from_chars_result res = from_chars(str.data(), end, *this, base);
+    if (res.ec != std::errc() || res.ptr != end) {
+        throw std::invalid_argument("invalid number");
     }
-    res.sign = str[0] == '-';
-    *this = res;
 }
 
 big_integer& big_integer::operator+=(big_integer const& rhs) {
+    int64_t x, y, r;
+    if (to_int64(*this, x) && to_int64(rhs, y) && !__builtin_add_overflow(x, y, &r)) {
+        return assign_int64(*this, r);
+    }
     if (sign == rhs.sign) {
         int carry = 0;
         for (size_t i = 0; i < rhs.num.size() || carry; i++) {
@@ -105,6 +156,10 @@ big_integer& big_integer::operator+=(big_integer const& rhs) {
 }
 
 big_integer& big_integer::operator-=(big_integer const& rhs) {
+    int64_t x, y, r;
+    if (to_int64(*this, x) && to_int64(rhs, y) && !__builtin_sub_overflow(x, y, &r)) {
+        return assign_int64(*this, r);
+    }
     if (rhs == 0) {
         return *this;
     }
@@ -131,118 +186,130 @@ big_integer& big_integer::operator-=(big_integer const& rhs) {
 }
 
 big_integer& big_integer::operator*=(big_integer const& rhs) {
-    big_integer res = 0;
-    res.num.resize(num.size() + rhs.num.size() + 1);
-    res.sign = sign != rhs.sign;
-    for (size_t i = 0; i < num.size(); i++) {
-        uint32_t carry = 0;
-        for (size_t j = 0; j < rhs.num.size() || carry; j++) {
-            if (j == rhs.num.size()) {
-                res.num[i + j] = carry;
-                break;
-            }
-            std::pair<uint32_t, uint32_t> p = mul(num[i], rhs.num[j]);
-            p.first += addInt(p.second, carry);
-            carry = p.first;
-            carry += addInt(res.num[i + j], p.second);
-        }
+    int64_t x, y, r;
+    if (to_int64(*this, x) && to_int64(rhs, y) && !__builtin_mul_overflow(x, y, &r)) {
+        return assign_int64(*this, r);
     }
-    *this = res;
-    normalize();
-    return *this;
+    big_integer const& lhs = *this;
+    size_t n = lhs.num.size(), m = rhs.num.size();
+    uint32_t const* a = lhs.num.data();
+    uint32_t const* b = rhs.num.data();
+    std::vector<uint32_t> res(n + m);
+    if (n == m && (a == b || cmp_n(a, b, n) == 0)) {
+        sqr_n_parallel(res.data(), a, n);
+    } else {
+        mul_n_parallel(res.data(), a, n, b, m);
+    }
+    return *this = from_limbs(std::move(res), sign != rhs.sign);
 }
 
-uint32_t trial(uint64_t a, uint64_t b, uint64_t d) {
-    uint64_t x = (a << SHIFT) + b;
-    uint64_t y = d;
-    return x / y;
+big_integer& big_integer::operator/=(big_integer const& rhs) {
+    int64_t x, y;
+    if (to_int64(*this, x) && to_int64(rhs, y) && y != 0 && !(x == INT64_MIN && y == -1)) {
+        return assign_int64(*this, x / y);
+    }
+    return *this = big_divisor(rhs).div(*this);
 }
 
-bool smaller(big_integer &a, big_integer &b, size_t k, size_t m) {
-    for (std::ptrdiff_t i = k - 1; i >= 0; i--) {
-        if (a.num[i] != (m - k + i < b.num.size() ? b.num[m - k + i] : 0)) {
-            return a.num[i] < (m - k + i < b.num.size() ? b.num[m - k + i] : 0);
-        }
+big_integer& big_integer::operator%=(big_integer const& rhs) {
+    int64_t x, y;
+    if (to_int64(*this, x) && to_int64(rhs, y) && y != 0 && !(x == INT64_MIN && y == -1)) {
+        return assign_int64(*this, x % y);
     }
-    return false;
+    return *this = big_divisor(rhs).mod(*this);
 }
 
-void difference(big_integer &a, big_integer &b, size_t k, size_t m) {
-    bool carry = false;
-    for (size_t i = 0; i < m; ++i) {
-        int64_t c = (int64_t) a.num[k - m + i] -
-                    (i < b.num.size() ? b.num[i] : 0) -
-                    carry;
-        carry = c < 0;
-        a.num[k - m + i] = c;
+big_integer& big_integer::add_scalar(uint64_t b, bool negative) {
+    int64_t x, y, r;
+    if (to_int64(*this, x) && word_to_int64(b, negative, y) && !__builtin_add_overflow(x, y, &r)) {
+        return assign_int64(*this, r);
+    }
+    if (b == 0) {
+        return *this;
+    }
+    uint32_t words[2] = {static_cast<uint32_t>(b), static_cast<uint32_t>(b >> SHIFT)};
+    size_t n = num.size(), bn = words[1] != 0 ? 2 : 1;
+    if (sign == negative) {
+        if (n < bn) {
+            num.resize(bn);
+            n = bn;
+        }
+        uint32_t carry = add(num.data(), num.data(), n, words, bn);
+        if (carry != 0) {
+            num.push_back(carry);
+        }
+        return *this;
     }
-    if (!a.num.back()) {
-        a.num.pop_back();
+    if (n <= 2 && low_word(*this) < b) {
+        return assign_word(*this, b - low_word(*this), negative);
     }
+    sub(num.data(), num.data(), n, words, bn);
+    normalize();
+    return *this;
 }
 
+big_integer& big_integer::mul_scalar(uint64_t b, bool negative) {
+    int64_t x, y, r;
+    if (to_int64(*this, x) && word_to_int64(b, negative, y) && !__builtin_mul_overflow(x, y, &r)) {
+        return assign_int64(*this, r);
+    }
+    uint32_t words[2] = {static_cast<uint32_t>(b), static_cast<uint32_t>(b >> SHIFT)};
+    size_t n = num.size();
+    if (words[1] == 0) {
+        uint32_t carry = mul_1(num.data(), num.data(), n, words[0]);
+        if (carry != 0) {
+            num.push_back(carry);
+        }
+        sign = sign != negative;
+        normalize();
+        return *this;
+    }
+    big_integer const& self = *this;
+    std::vector<uint32_t> res(n + 2);
+    mul_basecase(res.data(), self.num.data(), n, words, 2);
+    return *this = from_limbs(std::move(res), sign != negative);
+}
 
-big_integer div_short(big_integer a, uint32_t b) {
-    big_integer res;
-    res.num.resize(a.num.size());
-    uint64_t ost = 0;
-    for (size_t i = a.num.size(); i > 0; i--) {
-        ost <<= SHIFT;
-        ost += a.num[i - 1];
-        uint32_t cur = ost / b;
-        ost -= cur * b;
-        res.num[i - 1] = cur;
+big_integer& big_integer::div_scalar(uint64_t b, bool negative) {
+    if (b == 0) {
+        throw std::invalid_argument("division by zero");
     }
-    res.normalize();
-    return res;
+    int64_t x, y;
+    if (to_int64(*this, x) && word_to_int64(b, negative, y) && !(x == INT64_MIN && y == -1)) {
+        return assign_int64(*this, x / y);
+    }
+    divmod_small(*this, b);
+    sign = sign != negative;
+    normalize();
+    return *this;
 }
 
-big_integer& big_integer::operator/=(big_integer const& rhs) {
-    if (rhs == 0) {
+big_integer& big_integer::mod_scalar(uint64_t b, bool negative) {
+    if (b == 0) {
         throw std::invalid_argument("division by zero");
     }
-    big_integer a = *this;
-    big_integer b = rhs;
-    bool new_sign = a.sign ^ b.sign;
-    a.sign = b.sign = false;
-    if (a < b) {
-        return *this = 0;
-    }
-    if (b.num.size() == 1) {
-        a = div_short(a, b.num.back());
-        a.sign = new_sign;
-        return *this = a;
-    }
-    uint32_t f = (1ULL << SHIFT) / (b.num.back() + 1);
-    a *= f;
-    b *= f;
-    big_integer res;
-    size_t n = a.num.size() + 1, m = b.num.size() + 1;
-    a.num.push_back(0);
-    res.num.resize(n - m + 1);
-    size_t j = res.num.size() - 1;
-    for (size_t i = m; i <= n; i++) {
-        uint32_t cur = trial(
-                a.num.back(),
-                a.num.size() >= 2 ? a.num[a.num.size() - 2] : 0U,
-                b.num.back());
-        big_integer t = b * cur;
-        while (smaller(a, t, a.num.size(), m)) {
-            cur--;
-            t -= b;
-        }
-        res.num[j--] = cur;
-        difference(a, t, a.num.size(), m);
+    int64_t x, y;
+    if (to_int64(*this, x) && word_to_int64(b, negative, y) && !(x == INT64_MIN && y == -1)) {
+        return assign_int64(*this, x % y);
     }
-    res.normalize();
-    res.sign = new_sign;
-    return *this = res;
+    big_integer const& self = *this;
+    uint32_t const* a = self.num.data();
+    size_t n = self.num.size();
+    uint64_t r = b >> SHIFT == 0 ? mod_1(a, n, static_cast<uint32_t>(b)) : divrem_2(nullptr, a, n, b);
+    return assign_word(*this, r, sign);
 }
 
-big_integer& big_integer::operator%=(big_integer const& rhs) {
-    big_integer res = *this - (*this / rhs) * rhs;
-    res.normalize();
-    return *this = res;
+int big_integer::cmp_scalar(uint64_t b, bool negative) const {
+    bool neg = negative && b != 0;
+    if (sign != neg) {
+        return sign ? -1 : 1;
+    }
+    int res = 1;
+    if (num.size() <= 2) {
+        uint64_t a = low_word(*this);
+        res = a < b ? -1 : a > b;
+    }
+    return sign ? -res : res;
 }
 
 big_integer bitwise_operations(big_integer a, big_integer b, std::function<uint32_t(uint32_t, uint32_t)> f) {
@@ -301,76 +368,32 @@ big_integer& big_integer::operator<<=(int rhs) {
     if (rhs < 0) {
         throw std::invalid_argument("negative shift");
     }
-    big_integer res = *this;
-    res.sign = sign;
-    sign = false;
-    for (size_t i = 0; i <= rhs / (SHIFT - 1) + 1; i++) {
-        res.num.push_back(0);
-    }
-    for (size_t i = 0; i < res.num.size(); i++) {
-        ptrdiff_t left = i * SHIFT - rhs;
-        ptrdiff_t right = (i + 1) * SHIFT - 1 - rhs;
-        ptrdiff_t numLeft = left / SHIFT;
-        ptrdiff_t numRight = right / SHIFT;
-        uint32_t cnt = (SHIFT - rhs % SHIFT) % SHIFT;
-        uint32_t a, b;
-        if (left < 0 || numLeft >= (ptrdiff_t)num.size()) {
-            a = 0;
-        } else {
-            a = (sign ? ~num[numLeft] + 1 : num[numLeft]);
-        }
-        if (right < 0 || numRight >= (ptrdiff_t)num.size()) {
-            b = 0;
-        } else {
-            b = (sign ? ~num[numRight] + 1 : num[numRight]);
-        }
-        a >>= cnt;
-        b &= (1U << cnt) - 1U;
-        res.num[i] = (cnt ? (b << (SHIFT - cnt)) : 0) + a;
-        if (sign) {
-            res.num[i] = ~res.num[i] + 1;
-        }
-    }
-    res.normalize();
-    return *this = res;
+    big_integer const& self = *this;
+    size_t n = self.num.size(), whole = rhs / SHIFT;
+    std::vector<uint32_t> res(whole + n + 1, 0);
+    res[whole + n] = lshift(res.data() + whole, self.num.data(), n, rhs % SHIFT);
+    return *this = from_limbs(std::move(res), sign);
 }
 
 big_integer& big_integer::operator>>=(int rhs) {
     if (rhs < 0) {
         throw std::invalid_argument("negative shift");
     }
-    big_integer res = *this;
-    res.sign = sign;
-    sign = false;
-    for (size_t i = 0; i < res.num.size(); i++) {
-        ptrdiff_t left = i * SHIFT + rhs;
-        ptrdiff_t right = (i + 1) * SHIFT - 1 + rhs;
-        ptrdiff_t numLeft = left / SHIFT;
-        ptrdiff_t numRight = right / SHIFT;
-        uint32_t cnt = rhs % SHIFT;
-        uint32_t a, b;
-        if (numLeft >= (ptrdiff_t) num.size()) {
-            a = sign * UINT32_MAX;
-        } else {
-            a = (sign ? ~num[numLeft] + 1 : num[numLeft]);
-        }
-        if (numRight >= (ptrdiff_t)num.size()) {
-            b = sign * UINT32_MAX;
-        } else {
-            b = (sign ? ~num[numRight] + 1 : num[numRight]);
-        }
-        a >>= cnt;
-        b &= (1U << cnt) - 1U;
-        res.num[i] = (b << (SHIFT - cnt)) + a;
-        if (sign) {
-            res.num[i] = ~res.num[i] + 1;
-        }
+    big_integer const& self = *this;
+    size_t n = self.num.size(), whole = rhs / SHIFT;
+    if (whole >= n) {
+        return *this = sign ? -1 : 0;
     }
-    res.normalize();
-    if (res.sign) {
-        res -= 1;
+    uint32_t const* a = self.num.data();
+    std::vector<uint32_t> res(n - whole);
+    bool inexact = rshift(res.data(), a + whole, n - whole, rhs % SHIFT) != 0 ||
+                   std::any_of(a, a + whole, [](uint32_t x) { return x != 0; });
+    bool negative = sign;
+    *this = from_limbs(std::move(res), negative);
+    if (negative && inexact) {
+        *this -= 1;
     }
-    return *this = res;
+    return *this;
 }
 
 big_integer big_integer::operator+() const {
@@ -457,6 +480,10 @@ bool operator!=(big_integer const& a, big_integer const& b) {
 }
 
 bool operator<(big_integer const& a, big_integer const& b){
+    int64_t x, y;
+    if (to_int64(a, x) && to_int64(b, y)) {
+        return x < y;
+    }
     if (a == b) {
         return false;
     }
@@ -491,22 +518,51 @@ bool operator>=(big_integer const& a, big_integer const& b) {
 }
 
 std::string to_string(big_integer const& a) {
-    std::string s;
-    big_integer x = a;
-    x.sign = false;
-    while (x != 0) {
-        s += (char)((x % 10).num.back() + '0');
-        x /= 10;
-    }
-    std::reverse(s.begin(), s.end());
-    if (s.length() == 0) {
-        s = "0";
-    } else {
-        s = (a.sign ? "-" : "") + s;
-    }
+    return to_string(a, 10);
+}
+
+std::string to_string(big_integer const& a, int base) {
+    std::string s(chars_needed(a, base), '\0');
+    s.resize(to_chars(&s[0], &s[0] + s.size(), a, base).ptr - s.data());
     return s;
 }
 
+// Follows std::hex and std::oct. Small values are formatted on the stack and
+// written straight to the stream.
+static int stream_base(std::ios_base const& s) {
+    std::ios_base::fmtflags basefield = s.flags() & std::ios_base::basefield;
+    return basefield == std::ios_base::hex ? 16 : basefield == std::ios_base::oct ? 8 : 10;
+}
+
 std::ostream& operator<<(std::ostream& s, big_integer const& a) {
-    return s << to_string(a);
+    int base = stream_base(s);
+    char buf[64];
+    if (s.width() != 0 || chars_needed(a, base) > sizeof(buf)) {
+        return s << to_string(a, base);
+    }
+    return s.write(buf, to_chars(buf, buf + sizeof(buf), a, base).ptr - buf);
+}
+
+// Digits go from the stream buffer into the parser one at a time, so nothing
+// past the number is consumed and no copy of the text is kept.
+std::istream& operator>>(std::istream& s, big_integer& a) {
+    std::istream::sentry guard(s);
+    if (!guard) {
+        return s;
+    }
+    incremental_parser parser(stream_base(s));
+    std::streambuf* buf = s.rdbuf();
+    std::streambuf::int_type c = buf->sgetc();
+    while (c != std::streambuf::traits_type::eof() && parser.feed(std::streambuf::traits_type::to_char_type(c))) {
+        c = buf->snextc();
+    }
+    if (c == std::streambuf::traits_type::eof()) {
+        s.setstate(std::ios_base::eofbit);
+    }
+    if (parser.has_digits()) {
+        a = parser.finish();
+    } else {
+        s.setstate(std::ios_base::failbit);
+    }
+    return s;
 }
@@ -4,10 +4,20 @@
 #include <cstddef>
 #include <gmp.h>
 #include <iosfwd>
+#include <memory>
 #include <vector>
 #include <cstdint>
+#include <type_traits>
 #include "shared_vector_small_object.h"
 
+template <typename T, typename R>
+using if_integral = typename std::enable_if<std::is_integral<T>::value, R>::type;
+
+template <typename T>
+uint64_t scalar_magnitude(T a) {
+    return a < 0 ? 0 - static_cast<uint64_t>(a) : static_cast<uint64_t>(a);
+}
+
 struct big_integer
 {
     shared_vector_small_object num;
@@ -17,7 +27,17 @@ struct big_integer
     big_integer(big_integer const& other);
     big_integer(int a);
     big_integer(unsigned int a);
-    big_integer(std::string const& str);
+    big_integer(long a);
+    big_integer(unsigned long a);
+    big_integer(long long a);
+    big_integer(unsigned long long a);
+    big_integer(std::string const& str, int base = 10);
+    // A read-only view of n limbs, least significant first, that are only
+    // copied when the value is first modified. They must stay valid and
+    // unchanged while the view or any copy of it reads them, which owner can
+    // ensure by holding whatever keeps them alive.
+    big_integer(uint32_t const* limbs, size_t n, bool negative = false,
+                std::shared_ptr<void const> owner = nullptr);
     ~big_integer();
 
     big_integer& operator=(big_integer const& other);
@@ -28,6 +48,39 @@ struct big_integer
     big_integer& operator/=(big_integer const& rhs);
     big_integer& operator%=(big_integer const& rhs);
 
+    // Native integers are applied as a 64-bit magnitude and a sign by the
+    // single-limb kernels, without building a big_integer for them.
+    template <typename T>
+    if_integral<T, big_integer&> operator+=(T rhs) {
+        return add_scalar(scalar_magnitude(rhs), rhs < 0);
+    }
+
+    template <typename T>
+    if_integral<T, big_integer&> operator-=(T rhs) {
+        return add_scalar(scalar_magnitude(rhs), !(rhs < 0));
+    }
+
+    template <typename T>
+    if_integral<T, big_integer&> operator*=(T rhs) {
+        return mul_scalar(scalar_magnitude(rhs), rhs < 0);
+    }
+
+    template <typename T>
+    if_integral<T, big_integer&> operator/=(T rhs) {
+        return div_scalar(scalar_magnitude(rhs), rhs < 0);
+    }
+
+    template <typename T>
+    if_integral<T, big_integer&> operator%=(T rhs) {
+        return mod_scalar(scalar_magnitude(rhs), rhs < 0);
+    }
+
+    big_integer& add_scalar(uint64_t b, bool negative);
+    big_integer& mul_scalar(uint64_t b, bool negative);
+    big_integer& div_scalar(uint64_t b, bool negative);
+    big_integer& mod_scalar(uint64_t b, bool negative);
+    int cmp_scalar(uint64_t b, bool negative) const;
+
     big_integer& operator&=(const big_integer& rhs);
     big_integer& operator|=(const big_integer& rhs);
     big_integer& operator^=(const big_integer& rhs);
@@ -77,7 +130,119 @@ bool operator>(big_integer const& a, big_integer const& b);
 bool operator<=(big_integer const& a, big_integer const& b);
 bool operator>=(big_integer const& a, big_integer const& b);
 
+template <typename T>
+if_integral<T, big_integer> operator+(big_integer a, T b) {
+    return a += b;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator+(T a, big_integer b) {
+    return b += a;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator-(big_integer a, T b) {
+    return a -= b;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator-(T a, big_integer b) {
+    return -(b -= a);
+}
+
+template <typename T>
+if_integral<T, big_integer> operator*(big_integer a, T b) {
+    return a *= b;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator*(T a, big_integer b) {
+    return b *= a;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator/(big_integer a, T b) {
+    return a /= b;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator/(T a, big_integer const& b) {
+    return big_integer(a) / b;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator%(big_integer a, T b) {
+    return a %= b;
+}
+
+template <typename T>
+if_integral<T, big_integer> operator%(T a, big_integer const& b) {
+    return big_integer(a) % b;
+}
+
+template <typename T>
+if_integral<T, bool> operator==(big_integer const& a, T b) {
+    return a.cmp_scalar(scalar_magnitude(b), b < 0) == 0;
+}
+
+template <typename T>
+if_integral<T, bool> operator==(T a, big_integer const& b) {
+    return b == a;
+}
+
+template <typename T>
+if_integral<T, bool> operator!=(big_integer const& a, T b) {
+    return !(a == b);
+}
+
+template <typename T>
+if_integral<T, bool> operator!=(T a, big_integer const& b) {
+    return !(b == a);
+}
+
+template <typename T>
+if_integral<T, bool> operator<(big_integer const& a, T b) {
+    return a.cmp_scalar(scalar_magnitude(b), b < 0) < 0;
+}
+
+template <typename T>
+if_integral<T, bool> operator<(T a, big_integer const& b) {
+    return b.cmp_scalar(scalar_magnitude(a), a < 0) > 0;
+}
+
+template <typename T>
+if_integral<T, bool> operator>(big_integer const& a, T b) {
+    return b < a;
+}
+
+template <typename T>
+if_integral<T, bool> operator>(T a, big_integer const& b) {
+    return b < a;
+}
+
+template <typename T>
+if_integral<T, bool> operator<=(big_integer const& a, T b) {
+    return !(b < a);
+}
+
+template <typename T>
+if_integral<T, bool> operator<=(T a, big_integer const& b) {
+    return !(b < a);
+}
+
+template <typename T>
+if_integral<T, bool> operator>=(big_integer const& a, T b) {
+    return !(a < b);
+}
+
+template <typename T>
+if_integral<T, bool> operator>=(T a, big_integer const& b) {
+    return !(a < b);
+}
+
 std::string to_string(big_integer const& a);
+std::string to_string(big_integer const& a, int base);
 std::ostream& operator<<(std::ostream& s, big_integer const& a);
+std::istream& operator>>(std::istream& s, big_integer& a);
 
 #endif // BIG_INTEGER_H
@@ -0,0 +1,209 @@
+#include "big_integer_array.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "limb_arithmetic.h"
+
+namespace {
+
+// The size of a without its zero top limbs; zero has none.
+size_t normalized_size(uint32_t const* a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) {
+        n--;
+    }
+    return n;
+}
+
+int cmp_magnitude(uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an != bn) {
+        return an < bn ? -1 : 1;
+    }
+    return cmp_n(a, b, an);
+}
+
+size_t value_size(big_integer const& a) {
+    return normalized_size(a.num.data(), a.num.size());
+}
+
+}
+
+big_integer_array::big_integer_array() = default;
+
+big_integer_array::big_integer_array(std::vector<big_integer> const& values) {
+    size_t total = 0;
+    for (big_integer const& a : values) {
+        total += value_size(a);
+    }
+    arena.reserve(total);
+    index.reserve(values.size());
+    for (big_integer const& a : values) {
+        push_back(a);
+    }
+}
+
+size_t big_integer_array::size() const {
+    return index.size();
+}
+
+bool big_integer_array::empty() const {
+    return index.empty();
+}
+
+size_t big_integer_array::arena_size() const {
+    return arena.size();
+}
+
+big_integer_array::entry big_integer_array::append(uint32_t const* limbs, size_t n, bool sign) {
+    entry e = {arena.size(), n, n, sign && n != 0};
+    arena.insert(arena.end(), limbs, limbs + n);
+    return e;
+}
+
+void big_integer_array::push_back(big_integer const& a) {
+    index.push_back(append(a.num.data(), value_size(a), a.sign));
+}
+
+void big_integer_array::set(size_t i, big_integer const& a) {
+    entry& e = index.at(i);
+    size_t n = value_size(a);
+    if (n <= e.capacity) {
+        std::copy_n(a.num.data(), n, arena.data() + e.offset);
+        e.size = n;
+        e.sign = a.sign && n != 0;
+    } else {
+        e = append(a.num.data(), n, a.sign);
+    }
+}
+
+void big_integer_array::clear() {
+    arena.clear();
+    index.clear();
+}
+
+big_integer big_integer_array::operator[](size_t i) const {
+    entry const& e = index.at(i);
+    return from_limbs(std::vector<uint32_t>(arena.data() + e.offset, arena.data() + e.offset + e.size), e.sign);
+}
+
+big_integer big_integer_array::view(size_t i) const {
+    entry const& e = index.at(i);
+    return big_integer(arena.data() + e.offset, e.size, e.sign);
+}
+
+// Signed addition of every pair into a new arena with room for the longer
+// operand and a carry. A result is written where the previous one ended,
+// so the arena only holds the normalized limbs.
+void big_integer_array::add(big_integer_array const& rhs) {
+    if (rhs.size() != size()) {
+        throw std::invalid_argument("array size mismatch");
+    }
+    size_t bound = 0;
+    for (size_t i = 0; i < size(); i++) {
+        bound += std::max(index[i].size, rhs.index[i].size) + 1;
+    }
+    std::vector<uint32_t> res(bound);
+    size_t pos = 0;
+    for (size_t i = 0; i < size(); i++) {
+        entry x = index[i], y = rhs.index[i];
+        uint32_t const* a = arena.data() + x.offset;
+        uint32_t const* b = rhs.arena.data() + y.offset;
+        uint32_t* r = res.data() + pos;
+        bool sign = x.sign;
+        if (x.sign == y.sign) {
+            if (x.size < y.size) {
+                std::swap(a, b);
+                std::swap(x, y);
+            }
+            r[x.size] = ::add(r, a, x.size, b, y.size);
+        } else {
+            if (cmp_magnitude(a, x.size, b, y.size) < 0) {
+                std::swap(a, b);
+                std::swap(x, y);
+                sign = !sign;
+            }
+            sub(r, a, x.size, b, y.size);
+            r[x.size] = 0;
+        }
+        size_t n = normalized_size(r, x.size + 1);
+        index[i] = {pos, n, n, sign && n != 0};
+        pos += n;
+    }
+    res.resize(pos);
+    arena.swap(res);
+}
+
+void big_integer_array::mul_scalar(uint64_t b, bool negative) {
+    uint32_t m[2] = {static_cast<uint32_t>(b), static_cast<uint32_t>(b >> 32)};
+    size_t mn = m[1] == 0 ? 1 : 2;
+    std::vector<uint32_t> res(arena.size() + mn * size());
+    size_t pos = 0;
+    for (entry& e : index) {
+        uint32_t* r = res.data() + pos;
+        uint32_t const* a = arena.data() + e.offset;
+        if (e.size == 0 || b == 0) {
+            e = {pos, 0, 0, false};
+            continue;
+        }
+        if (mn == 1) {
+            r[e.size] = mul_1(r, a, e.size, m[0]);
+        } else {
+            mul_basecase(r, a, e.size, m, 2);
+        }
+        size_t n = normalized_size(r, e.size + mn);
+        e = {pos, n, n, e.sign != negative};
+        pos += n;
+    }
+    res.resize(pos);
+    arena.swap(res);
+}
+
+int big_integer_array::compare(uint32_t const* a, entry const& x, uint32_t const* b, entry const& y) {
+    if (x.sign != y.sign) {
+        return x.sign ? -1 : 1;
+    }
+    int c = cmp_magnitude(a, x.size, b, y.size);
+    return x.sign ? -c : c;
+}
+
+int big_integer_array::compare(size_t i, size_t j) const {
+    entry const& x = index.at(i);
+    entry const& y = index.at(j);
+    return compare(arena.data() + x.offset, x, arena.data() + y.offset, y);
+}
+
+std::vector<int> big_integer_array::compare(big_integer_array const& rhs) const {
+    if (rhs.size() != size()) {
+        throw std::invalid_argument("array size mismatch");
+    }
+    std::vector<int> res(size());
+    for (size_t i = 0; i < size(); i++) {
+        entry const& x = index[i];
+        entry const& y = rhs.index[i];
+        res[i] = compare(arena.data() + x.offset, x, rhs.arena.data() + y.offset, y);
+    }
+    return res;
+}
+
+void big_integer_array::sort() {
+    uint32_t const* limbs = arena.data();
+    std::stable_sort(index.begin(), index.end(), [limbs](entry const& x, entry const& y) {
+        return compare(limbs + x.offset, x, limbs + y.offset, y) < 0;
+    });
+}
+
+void big_integer_array::compact() {
+    size_t total = 0;
+    for (entry const& e : index) {
+        total += e.size;
+    }
+    std::vector<uint32_t> res;
+    res.reserve(total);
+    for (entry& e : index) {
+        size_t offset = res.size();
+        res.insert(res.end(), arena.data() + e.offset, arena.data() + e.offset + e.size);
+        e.offset = offset;
+        e.capacity = e.size;
+    }
+    arena.swap(res);
+}
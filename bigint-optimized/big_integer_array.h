@@ -0,0 +1,73 @@
+#ifndef BIGINT_BIG_INTEGER_ARRAY_H
+#define BIGINT_BIG_INTEGER_ARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "big_integer.h"
+
+// A sequence of big_integers whose limbs all live back to back in one
+// arena, indexed by offset and size, so that a pass over the values reads
+// memory in order instead of chasing one allocation per value. Batch
+// operations stream through the arena and write their results into a fresh
+// one in index order; single assignments reuse a value's slot when the new
+// value fits and otherwise append, leaving the old slot unused until
+// compact().
+class big_integer_array {
+public:
+    big_integer_array();
+    explicit big_integer_array(std::vector<big_integer> const& values);
+
+    size_t size() const;
+    bool empty() const;
+    // Limbs in the arena, used or not.
+    size_t arena_size() const;
+
+    void push_back(big_integer const& a);
+    void set(size_t i, big_integer const& a);
+    void clear();
+
+    big_integer operator[](size_t i) const;
+    // A read-only view of value i without copying it, valid until the array
+    // is next modified.
+    big_integer view(size_t i) const;
+
+    // this[i] += rhs[i] for arrays of the same size.
+    void add(big_integer_array const& rhs);
+
+    // this[i] *= rhs for every i.
+    template <typename T>
+    if_integral<T, void> mul(T rhs) {
+        mul_scalar(scalar_magnitude(rhs), rhs < 0);
+    }
+
+    void mul_scalar(uint64_t b, bool negative);
+
+    // The sign of this[i] - this[j].
+    int compare(size_t i, size_t j) const;
+    // The signs of this[i] - rhs[i] for arrays of the same size.
+    std::vector<int> compare(big_integer_array const& rhs) const;
+
+    // Sorts the values in increasing order by permuting the index; the limbs
+    // stay where they are until compact().
+    void sort();
+
+    // Rewrites the arena in index order without unused slots.
+    void compact();
+
+private:
+    struct entry {
+        size_t offset;
+        size_t size;
+        size_t capacity;
+        bool sign;
+    };
+
+    static int compare(uint32_t const* a, entry const& x, uint32_t const* b, entry const& y);
+    entry append(uint32_t const* limbs, size_t n, bool sign);
+
+    std::vector<uint32_t> arena;
+    std::vector<entry> index;
+};
+
+#endif //BIGINT_BIG_INTEGER_ARRAY_H
@@ -1,13 +1,34 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cassert>
+#include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <future>
 #include <random>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 #include <gtest/gtest.h>
+#include <unistd.h>
 
 #include "big_integer.h"
 #include "big_integer_gmp.h"
+#include "big_divisor.h"
+#include "limb_arithmetic.h"
+#include "number_theory.h"
+#include "fixed_width.h"
+#include "lane_batch.h"
+#include "constant_division.h"
+#include "radix_conversion.h"
+#include "byte_conversion.h"
+#include "limb_file.h"
+#include "parallel.h"
+#include "async.h"
+#include "big_integer_array.h"
 
 TEST(correctness, two_plus_two) {
   EXPECT_EQ(big_integer(4), big_integer(2) + big_integer(2));
@@ -776,6 +797,1172 @@ TEST(correctness_random, mod) {
   }
 }
 
+TEST(correctness, big_divisor) {
+  big_divisor d(-7);
+  EXPECT_EQ(-2, d.div(20));
+  EXPECT_EQ(6, d.mod(20));
+  EXPECT_EQ(-6, d.mod(-20));
+  EXPECT_EQ(0, d.div(6));
+  EXPECT_EQ(-7, d.value());
+
+  std::pair<big_integer, big_integer> qr = big_divisor(big_integer("18446744073709551616")).divmod(big_integer("-36893488147419103233"));
+  EXPECT_EQ(-2, qr.first);
+  EXPECT_EQ(-1, qr.second);
+
+  EXPECT_THROW(big_divisor(0), std::invalid_argument);
+}
+
+TEST(correctness_random, big_divisor) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp b;
+    b.random(max_size / 4 + itn * 7, rng);
+    big_divisor d{big_integer(to_string(b))};
+    for (size_t i = 0; i != 10; ++i) {
+      big_integer_gmp a;
+      a.random(max_size, rng);
+      std::pair<big_integer, big_integer> qr = d.divmod(big_integer(to_string(a)));
+      EXPECT_EQ(to_string(a / b), to_string(qr.first));
+      EXPECT_EQ(to_string(a % b), to_string(qr.second));
+    }
+  }
+}
+
+TEST(correctness_random, divmod_small) {
+  std::mt19937_64 rng(36);
+  for (size_t itn = 0; itn != number_of_iterations * 100; ++itn) {
+    big_integer a = rand_big(itn % 20 + 1);
+    uint64_t d = rng() >> (rng() % 64);
+    if (d == 0)
+      continue;
+    big_integer q = a;
+    uint64_t r = divmod_small(q, d);
+    big_integer D(std::to_string(d));
+    EXPECT_EQ(big_divisor(D).div(a), q);
+    EXPECT_EQ(big_divisor(D).mod(a), a < 0 ? -big_integer(r) : big_integer(r));
+  }
+  big_integer z = -5;
+  EXPECT_EQ(5u, divmod_small(z, UINT64_MAX));
+  EXPECT_EQ(0, z);
+  EXPECT_FALSE(z.sign);
+  EXPECT_THROW(divmod_small(z, 0), std::invalid_argument);
+}
+
+TEST(correctness_random, divexact) {
+  for (size_t itn = 0; itn != number_of_iterations * 30; ++itn) {
+    big_integer q = rand_big((itn % 40 + 1) * (itn % 4 == 0 ? 10 : 1));
+    big_integer b = rand_big(itn % 13 + 1) << static_cast<int>(itn % 70);
+    big_integer a = q * b;
+    EXPECT_EQ(q, divexact(a, b));
+    EXPECT_EQ(-q, divexact(a, -b));
+    EXPECT_EQ(b, divexact(a, q));
+  }
+  EXPECT_EQ(0, divexact(0, 7));
+  EXPECT_EQ(-(big_integer(1) << 90), divexact(big_integer(3) << 100, -(big_integer(3) << 10)));
+  EXPECT_EQ(binomial(200, 100), divexact(factorial(200), factorial(100) * factorial(100)));
+  EXPECT_THROW(divexact(1, 0), std::invalid_argument);
+}
+
+template <uint32_t D>
+void check_constant_division(big_integer const& x) {
+  big_integer r = x % D;
+  EXPECT_EQ(r < 0 ? -r : r, mod_const<D>(x));
+  EXPECT_EQ(r == 0, divisible_by<D>(x));
+}
+
+TEST(correctness_random, constant_division) {
+  for (size_t itn = 0; itn != number_of_iterations * 100; ++itn) {
+    big_integer x = rand_big(itn % 50 + 1);
+    for (big_integer y : {x, x * 3 * 5 * 7 * 641 * 65537 * 1000000, x - x % 1000000007}) {
+      check_constant_division<1>(y);
+      check_constant_division<2>(y);
+      check_constant_division<3>(y);
+      check_constant_division<6>(y);
+      check_constant_division<7>(y);
+      check_constant_division<10>(y);
+      check_constant_division<641>(y);
+      check_constant_division<4096>(y);
+      check_constant_division<65537>(y);
+      check_constant_division<6700417>(y);
+      check_constant_division<1000000>(y);
+      check_constant_division<1000000007>(y);
+      check_constant_division<4294967295u>(y);
+      check_constant_division<4294967291u>(y);
+    }
+  }
+}
+
+std::string naive_to_string(big_integer a, int base) {
+  std::string s;
+  bool negative = a < 0;
+  do {
+    big_integer d = a % base;
+    int v = static_cast<int>((d < 0 ? -d : d).num[0]);
+    s += "0123456789abcdefghijklmnopqrstuvwxyz"[v];
+    a /= base;
+  } while (a != 0);
+  if (negative)
+    s += '-';
+  std::reverse(s.begin(), s.end());
+  return s;
+}
+
+TEST(correctness, to_chars) {
+  char buf[8];
+  to_chars_result res = to_chars(buf, buf + sizeof(buf), big_integer(-1234567), 10);
+  EXPECT_EQ(std::errc(), res.ec);
+  EXPECT_EQ("-1234567", std::string(buf, res.ptr));
+  res = to_chars(buf, buf + 7, big_integer(-1234567), 10);
+  EXPECT_EQ(std::errc::value_too_large, res.ec);
+  EXPECT_EQ(buf + 7, res.ptr);
+  res = to_chars(buf, buf + 1, big_integer(0), 36);
+  EXPECT_EQ("0", std::string(buf, res.ptr));
+  res = to_chars(buf, buf + sizeof(buf), big_integer(35 * 36 + 10), 36);
+  EXPECT_EQ("za", std::string(buf, res.ptr));
+  EXPECT_THROW(chars_needed(1, 37), std::invalid_argument);
+}
+
+TEST(correctness, from_chars) {
+  std::string s = "-00123x";
+  big_integer a = 5;
+  from_chars_result res = from_chars(s.data(), s.data() + s.size(), a);
+  EXPECT_EQ(std::errc(), res.ec);
+  EXPECT_EQ(s.data() + 6, res.ptr);
+  EXPECT_EQ(-123, a);
+  s = "-x";
+  res = from_chars(s.data(), s.data() + s.size(), a);
+  EXPECT_EQ(std::errc::invalid_argument, res.ec);
+  EXPECT_EQ(s.data(), res.ptr);
+  EXPECT_EQ(-123, a);
+  s = "-0";
+  from_chars(s.data(), s.data() + s.size(), a);
+  EXPECT_EQ(0, a);
+  EXPECT_FALSE(a.sign);
+  s = "ZzZ";
+  from_chars(s.data(), s.data() + s.size(), a, 36);
+  EXPECT_EQ(35 * 36 * 36 + 35 * 36 + 35, a);
+  EXPECT_THROW(big_integer("12a"), std::invalid_argument);
+  EXPECT_THROW(big_integer(""), std::invalid_argument);
+}
+
+TEST(correctness_random, radix_conversion) {
+  for (size_t itn = 0; itn != number_of_iterations * 4; ++itn) {
+    big_integer a = rand_big(itn % 4 == 0 ? 150 : itn + 1);
+    for (int base : {10, 2, 3, 7, 16, 36}) {
+      std::string expected = naive_to_string(a, base);
+      std::vector<char> buf(chars_needed(a, base));
+      to_chars_result res = to_chars(buf.data(), buf.data() + buf.size(), a, base);
+      EXPECT_EQ(expected, std::string(buf.data(), res.ptr));
+      buf.resize(expected.size());
+      res = to_chars(buf.data(), buf.data() + buf.size(), a, base);
+      EXPECT_EQ(expected, std::string(buf.data(), res.ptr));
+      res = to_chars(buf.data(), buf.data() + buf.size() - 1, a, base);
+      EXPECT_EQ(std::errc::value_too_large, res.ec);
+      EXPECT_EQ(buf.data() + buf.size() - 1, res.ptr);
+      big_integer b;
+      from_chars_result parsed = from_chars(expected.data(), expected.data() + expected.size(), b, base);
+      EXPECT_EQ(expected.data() + expected.size(), parsed.ptr);
+      EXPECT_EQ(a, b);
+    }
+  }
+}
+
+TEST(correctness, power_of_two_bases) {
+  big_integer a("-DeadBeef0123456789abcdef", 16);
+  EXPECT_EQ(-((big_integer(0xdeadbeefu) << 64) + (big_integer(0x01234567u) << 32) + 0x89abcdefu), a);
+  EXPECT_EQ("-deadbeef0123456789abcdef", to_string(a, 16));
+  EXPECT_EQ(25u, chars_needed(a, 16));
+  EXPECT_EQ("777", to_string(big_integer("111111111", 2), 8));
+  EXPECT_EQ("0", to_string(big_integer(0), 2));
+  EXPECT_EQ("1" + std::string(100, '0'), to_string(big_integer(1) << 100, 2));
+  EXPECT_EQ("2" + std::string(33, '0'), to_string(big_integer(1) << 100, 8));
+  EXPECT_EQ(big_integer(1) << 100, big_integer("1" + std::string(25, '0'), 16));
+  std::string hex, lower;
+  for (int i = 0; i != 100; ++i) {
+    hex += "9aFb0E1c";
+    lower += "9afb0e1c";
+  }
+  big_integer h("7" + hex, 16);
+  EXPECT_EQ("7" + lower, to_string(h, 16));
+  EXPECT_EQ(h, big_integer(to_string(h, 2), 2));
+  EXPECT_EQ(h, big_integer(to_string(h, 4), 4));
+  EXPECT_THROW(big_integer("12", 2), std::invalid_argument);
+
+  std::ostringstream out;
+  out << std::hex << big_integer(255) << ' ' << std::oct << big_integer(-8) << ' ' << std::dec << big_integer(10);
+  EXPECT_EQ("ff -10 10", out.str());
+}
+
+TEST(correctness_random, power_of_two_bases) {
+  for (size_t itn = 0; itn != number_of_iterations * 10; ++itn) {
+    big_integer a = rand_big(itn + 1);
+    for (int base : {2, 4, 8, 16, 32}) {
+      std::string s = to_string(a, base);
+      EXPECT_EQ(naive_to_string(a, base), s);
+      EXPECT_EQ(s.size(), chars_needed(a, base));
+      EXPECT_EQ(a, big_integer(s, base));
+    }
+  }
+}
+
+TEST(correctness_random, decimal_large) {
+  std::default_random_engine rng(39);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * (itn + 1) * 8, rng);
+    if (itn % 2 == 1)
+      a = -a;
+    std::string s = to_string(a);
+    big_integer b(s);
+    EXPECT_EQ(s, to_string(b));
+    std::ostringstream out;
+    out << b;
+    EXPECT_EQ(s, out.str());
+  }
+}
+
+TEST(correctness, incremental_parser) {
+  incremental_parser parser;
+  std::string a = "-1234", b = "5678", c = "90x1";
+  EXPECT_EQ(a.data() + a.size(), parser.feed(a.data(), a.data() + a.size()));
+  EXPECT_EQ(b.data() + b.size(), parser.feed(b.data(), b.data() + b.size()));
+  EXPECT_EQ(c.data() + 2, parser.feed(c.data(), c.data() + c.size()));
+  EXPECT_FALSE(parser.feed('1'));
+  EXPECT_EQ(big_integer("-1234567890"), parser.finish());
+
+  incremental_parser empty(16);
+  EXPECT_TRUE(empty.feed('-'));
+  EXPECT_FALSE(empty.feed('g'));
+  EXPECT_FALSE(empty.has_digits());
+  EXPECT_THROW(empty.finish(), std::invalid_argument);
+  EXPECT_THROW(incremental_parser(1), std::invalid_argument);
+
+  std::istringstream in("  12 -340000000000000000000000\n7x -");
+  big_integer x, y, z, w;
+  in >> x >> y >> z;
+  EXPECT_EQ(12, x);
+  EXPECT_EQ(big_integer("-340000000000000000000000"), y);
+  EXPECT_EQ(7, z);
+  EXPECT_EQ('x', in.get());
+  EXPECT_FALSE(in >> w);
+  EXPECT_EQ(0, w);
+
+  std::istringstream hex("-Ff");
+  hex >> std::hex >> x;
+  EXPECT_EQ(-255, x);
+  EXPECT_TRUE(hex.eof());
+}
+
+TEST(correctness_random, incremental_parser) {
+  std::default_random_engine rng(43);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * (itn + 1) * 4, rng);
+    if (itn % 2 == 1)
+      a = -a;
+    std::string s = to_string(a);
+    incremental_parser parser;
+    for (size_t pos = 0; pos < s.size();) {
+      size_t len = std::min<size_t>(rng() % 3000 + 1, s.size() - pos);
+      EXPECT_EQ(s.data() + pos + len, parser.feed(s.data() + pos, s.data() + pos + len));
+      pos += len;
+    }
+    EXPECT_EQ(s, to_string(parser.finish()));
+    std::istringstream in(s + " 1");
+    big_integer b;
+    in >> b;
+    EXPECT_EQ(s, to_string(b));
+  }
+}
+
+TEST(correctness, byte_conversion) {
+  big_integer a = (big_integer(0x01020304u) << 32) + 0x05060708u;
+  unsigned char buf[16];
+  EXPECT_EQ(2u, export_words(a, 4));
+  EXPECT_EQ(2u, export_bytes(buf, a, 4, word_order::most_significant_first, byte_order::big));
+  EXPECT_EQ(std::vector<unsigned char>({1, 2, 3, 4, 5, 6, 7, 8}), std::vector<unsigned char>(buf, buf + 8));
+  EXPECT_EQ(2u, export_bytes(buf, a, 4, word_order::least_significant_first, byte_order::big));
+  EXPECT_EQ(std::vector<unsigned char>({5, 6, 7, 8, 1, 2, 3, 4}), std::vector<unsigned char>(buf, buf + 8));
+  EXPECT_EQ(3u, export_bytes(buf, -a, 3, word_order::least_significant_first, byte_order::little));
+  EXPECT_EQ(std::vector<unsigned char>({8, 7, 6, 5, 4, 3, 2, 1, 0}), std::vector<unsigned char>(buf, buf + 9));
+  EXPECT_EQ(a, import_bytes(buf, 3, 3, word_order::least_significant_first, byte_order::little));
+  EXPECT_EQ(0u, export_words(0, 8));
+  EXPECT_EQ(0u, export_bytes(buf, 0, 8, word_order::most_significant_first, byte_order::native));
+  EXPECT_EQ(0, import_bytes(buf, 0, 8, word_order::most_significant_first, byte_order::native));
+  EXPECT_THROW(export_words(a, 0), std::invalid_argument);
+}
+
+TEST(correctness_random, byte_conversion) {
+  mpz_t ref;
+  mpz_init(ref);
+  for (size_t itn = 0; itn != number_of_iterations * 10; ++itn) {
+    big_integer a = rand_big(itn % 50 + 1);
+    mpz_set_str(ref, to_string(a).c_str(), 10);
+    for (size_t size : {1, 2, 3, 4, 8, 16}) {
+      for (word_order order : {word_order::most_significant_first, word_order::least_significant_first}) {
+        for (byte_order endian : {byte_order::big, byte_order::little, byte_order::native}) {
+          int gmp_order = order == word_order::most_significant_first ? 1 : -1;
+          int gmp_endian = endian == byte_order::big ? 1 : endian == byte_order::little ? -1 : 0;
+          size_t count = export_words(a, size), gmp_count;
+          std::vector<unsigned char> bytes(count * size), gmp_bytes(count * size);
+          EXPECT_EQ(count, export_bytes(bytes.data(), a, size, order, endian));
+          mpz_export(gmp_bytes.data(), &gmp_count, gmp_order, size, gmp_endian, 0, ref);
+          EXPECT_EQ(gmp_count, count);
+          EXPECT_EQ(gmp_bytes, bytes);
+          EXPECT_EQ(a, import_bytes(bytes.data(), count, size, order, endian));
+        }
+      }
+    }
+  }
+  mpz_clear(ref);
+}
+
+TEST(correctness, limb_view) {
+  std::vector<uint32_t> limbs = {1, 2, 3, 4, 0};
+  big_integer expected = (big_integer(4) << 96) + (big_integer(3) << 64) + (big_integer(2) << 32) + 1;
+  big_integer a(limbs.data(), limbs.size(), true);
+  big_integer const& view = a;
+  EXPECT_EQ(limbs.data(), view.num.data());
+  EXPECT_EQ(4u, a.num.size());
+  EXPECT_EQ(-expected, a);
+  big_integer b = a;
+  b -= 1;
+  EXPECT_EQ(-expected - 1, b);
+  EXPECT_EQ(-expected, a);
+  EXPECT_EQ(limbs.data(), view.num.data());
+  EXPECT_EQ(std::vector<uint32_t>({1, 2, 3, 4, 0}), limbs);
+  a.sign = false;
+  a <<= 32;
+  EXPECT_EQ(expected << 32, a);
+  EXPECT_EQ(2u, limbs[1]);
+  EXPECT_EQ(big_integer(5), big_integer(std::vector<uint32_t>({5, 0, 0}).data(), 3));
+  EXPECT_EQ(0, big_integer(limbs.data(), 0, true));
+
+  std::shared_ptr<std::vector<uint32_t>> owned = std::make_shared<std::vector<uint32_t>>(limbs);
+  big_integer c(owned->data(), owned->size(), false, owned);
+  owned.reset();
+  EXPECT_EQ(expected, c);
+}
+
+namespace {
+// A fresh file in the temporary directory, removed when the test leaves the
+// scope, whether or not its assertions held.
+struct temp_file {
+  std::string path;
+
+  explicit temp_file(char const* name) {
+    char const* dir = std::getenv("TMPDIR");
+    std::string pattern = std::string(dir != nullptr && *dir != '\0' ? dir : "/tmp") + "/" + name + "_XXXXXX";
+    std::vector<char> buf(pattern.begin(), pattern.end());
+    buf.push_back('\0');
+    int fd = mkstemp(buf.data());
+    if (fd >= 0) {
+      close(fd);
+    }
+    path = buf.data();
+  }
+
+  ~temp_file() {
+    std::remove(path.c_str());
+  }
+
+  temp_file(temp_file const&) = delete;
+  temp_file& operator=(temp_file const&) = delete;
+};
+}
+
+TEST(correctness, limb_file) {
+  temp_file file("limb_file_test");
+  std::string const& path = file.path;
+  big_integer a = -(big_integer(1) << 1000) + 12345;
+  save_limb_file(path, a);
+  big_integer b = load_limb_file(path);
+  EXPECT_EQ(a, b);
+  b += 1;
+  EXPECT_EQ(a + 1, b);
+  EXPECT_EQ(a, load_limb_file(path));
+  save_limb_file(path, 0);
+  EXPECT_EQ(0, load_limb_file(path));
+  save_limb_file(path, -7);
+  EXPECT_EQ(-7, load_limb_file(path));
+  save_limb_file(path, a);
+  big_integer copy = load_limb_file(path, false);
+  save_limb_file(path, 0);
+  save_limb_file(path, a + 1);
+  EXPECT_EQ(a, copy);
+  EXPECT_EQ(a + 1, load_limb_file(path, false));
+
+  auto patch = [&](long offset, int byte) {
+    save_limb_file(path, a);
+    std::FILE* f = std::fopen(path.c_str(), "r+b");
+    std::fseek(f, offset, SEEK_SET);
+    std::fputc(byte, f);
+    std::fclose(f);
+  };
+  patch(0, 'X');
+  EXPECT_THROW(load_limb_file(path), std::invalid_argument);
+  for (int bit = 1; bit != 32; ++bit) {
+    patch(12 + bit / 8, (bit / 8 == 0 ? 1 : 0) | 1 << bit % 8);
+    EXPECT_THROW(load_limb_file(path), std::invalid_argument) << "flag bit " << bit;
+  }
+  for (long offset = 24; offset != 32; ++offset) {
+    patch(offset, 1);
+    EXPECT_THROW(load_limb_file(path), std::invalid_argument) << "reserved byte " << offset;
+  }
+  patch(12, 0);
+  EXPECT_EQ(-a, load_limb_file(path));
+  std::remove(path.c_str());
+  EXPECT_THROW(load_limb_file(path), std::system_error);
+}
+
+TEST(correctness_random, limb_file) {
+  temp_file file("limb_file_test");
+  std::string const& path = file.path;
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer a = rand_big(itn * 20 + 1);
+    if (itn % 2 == 1)
+      a = -a;
+    save_limb_file(path, a);
+    big_integer b = load_limb_file(path);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a * a, b * b);
+  }
+}
+
+TEST(correctness, parallel_for) {
+  std::vector<int> hits(1000);
+  set_shared_pool_threads(4);
+  parallel_for(hits.size(), 4, [&](size_t i) { hits[i]++; });
+  EXPECT_EQ(std::vector<int>(1000, 1), hits);
+  parallel_for(0, 4, [](size_t) { FAIL(); });
+  EXPECT_THROW(parallel_for(10, 3, [](size_t i) {
+    if (i == 7)
+      throw std::invalid_argument("task");
+  }), std::invalid_argument);
+  set_shared_pool_threads(0);
+}
+
+TEST(correctness, task_group) {
+  set_shared_pool_threads(4);
+  EXPECT_EQ(4u, shared_pool().threads());
+  std::atomic<int> sum(0);
+  std::function<void(int)> fork = [&](int depth) {
+    if (depth == 0) {
+      sum++;
+      return;
+    }
+    task_group tasks;
+    tasks.run([&, depth] { fork(depth - 1); });
+    tasks.run([&, depth] { fork(depth - 1); });
+    tasks.wait();
+  };
+  fork(8);
+  EXPECT_EQ(256, sum);
+  task_group failing;
+  failing.run([] { throw std::invalid_argument("task"); });
+  EXPECT_THROW(failing.wait(), std::invalid_argument);
+
+  set_shared_pool_pinning(true);
+  EXPECT_TRUE(shared_pool().pinned());
+  EXPECT_EQ(4u, shared_pool().threads());
+  sum = 0;
+  fork(10);
+  EXPECT_EQ(1024, sum);
+  set_shared_pool_pinning(false);
+  set_shared_pool_threads(0);
+  EXPECT_EQ(default_threads(), shared_pool().threads());
+  EXPECT_FALSE(shared_pool().pinned());
+}
+
+TEST(correctness, thread_pool) {
+  thread_pool pool(3);
+  std::atomic<int> done(0);
+  for (int i = 0; i < 100; ++i)
+    pool.submit([&] { done++; });
+  while (pool.run_one()) {
+  }
+  while (done != 100)
+    std::this_thread::yield();
+  EXPECT_FALSE(pool.run_one());
+}
+
+TEST(correctness_random, parallel_mul) {
+  for (unsigned threads : {1, 3, 4}) {
+    set_shared_pool_threads(threads);
+    for (size_t itn = 0; itn != 4; ++itn) {
+      big_integer a = rand_big(3000 + itn * 1500), b = rand_big(itn % 2 == 0 ? 2500 + itn * 700 : 900);
+      std::vector<uint32_t> serial(a.num.size() + b.num.size());
+      mul_n(serial.data(), a.num.data(), a.num.size(), b.num.data(), b.num.size());
+      EXPECT_EQ(from_limbs(serial, false), a * b);
+      std::vector<uint32_t> square(2 * a.num.size());
+      sqr_n(square.data(), a.num.data(), a.num.size());
+      EXPECT_EQ(from_limbs(square, false), a * a);
+    }
+  }
+  set_shared_pool_threads(0);
+}
+
+TEST(correctness_random, parallel_to_chars) {
+  std::default_random_engine rng(46);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * (itn + 1) * 8, rng);
+    if (itn % 2 == 1)
+      a = -a;
+    std::string expected = to_string(a);
+    big_integer b(expected);
+    set_shared_pool_threads(itn % 3 + 2);
+    EXPECT_EQ(expected, to_string(b));
+    std::vector<char> buf(expected.size());
+    to_chars_result res = to_chars(buf.data(), buf.data() + buf.size(), b);
+    EXPECT_EQ(buf.data() + buf.size(), res.ptr);
+    EXPECT_EQ(expected, std::string(buf.begin(), buf.end()));
+    res = to_chars(buf.data(), buf.data() + buf.size() - 1, b);
+    EXPECT_EQ(std::errc::value_too_large, res.ec);
+  }
+  set_shared_pool_threads(0);
+}
+
+TEST(correctness, async) {
+  big_integer a = pow(big_integer(3), 5000), b = pow(big_integer(7), 4000);
+  std::future<big_integer> product = async_mul(a, -b);
+  std::future<big_integer> power = async_pow(a, 3);
+  std::future<std::string> text = async_to_string(b, 16);
+  a += 1;
+  EXPECT_EQ((a - 1) * -b, product.get());
+  EXPECT_EQ((a - 1) * (a - 1) * (a - 1), power.get());
+  EXPECT_EQ(to_string(b, 16), text.get());
+
+  cancellation_token cancelled;
+  cancelled.cancel();
+  EXPECT_TRUE(cancelled.cancelled());
+  std::future<big_integer> never = async_mul(a, b, cancelled);
+  EXPECT_THROW(never.get(), operation_cancelled);
+  EXPECT_NO_THROW(check_cancelled());
+
+  for (unsigned threads : {1, 4}) {
+    set_shared_pool_threads(threads);
+    cancellation_token token;
+    std::future<big_integer> huge = async_pow(big_integer(3), 40000000, token);
+    std::future<std::string> digits = async_to_string(pow(big_integer(7), 500000), 10, token);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    token.cancel();
+    EXPECT_THROW(huge.get(), operation_cancelled);
+    EXPECT_THROW(digits.get(), operation_cancelled);
+  }
+  set_shared_pool_threads(0);
+}
+
+TEST(correctness, load_decimal_file) {
+  temp_file file("decimal_file_test");
+  std::string const& path = file.path;
+  std::string digits = to_string(pow(big_integer(3), 200000));
+  std::FILE* f = std::fopen(path.c_str(), "wb");
+  std::fprintf(f, " -%s\n", digits.c_str());
+  std::fclose(f);
+  EXPECT_EQ(-big_integer(digits), load_decimal_file(path, 4));
+  EXPECT_EQ(-big_integer(digits), load_decimal_file(path, 1));
+
+  f = std::fopen(path.c_str(), "wb");
+  std::fprintf(f, "12 34");
+  std::fclose(f);
+  EXPECT_THROW(load_decimal_file(path), std::invalid_argument);
+  f = std::fopen(path.c_str(), "wb");
+  std::fclose(f);
+  EXPECT_THROW(load_decimal_file(path), std::invalid_argument);
+  std::remove(path.c_str());
+  EXPECT_THROW(load_decimal_file(path), std::system_error);
+}
+
+TEST(correctness_random, parallel_from_chars) {
+  std::default_random_engine rng(44);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * (itn + 1) * 16, rng);
+    if (itn % 2 == 1)
+      a = -a;
+    std::string s = to_string(a) + "x";
+    set_shared_pool_threads(itn % 4 + 1);
+    for (unsigned threads : {2, 3, 8}) {
+      big_integer b;
+      from_chars_result res = parallel_from_chars(s.data(), s.data() + s.size(), b, 10, threads);
+      EXPECT_EQ(s.data() + s.size() - 1, res.ptr);
+      EXPECT_EQ(s.substr(0, s.size() - 1), to_string(b));
+    }
+  }
+  set_shared_pool_threads(0);
+}
+
+TEST(correctness, big_integer_array) {
+  big_integer_array a({1, -2, big_integer(1) << 100, 0});
+  EXPECT_EQ(4u, a.size());
+  EXPECT_EQ(6u, a.arena_size());
+  EXPECT_EQ(-2, a[1]);
+  EXPECT_EQ(big_integer(1) << 100, a.view(2));
+  EXPECT_EQ(0, a[3]);
+
+  a.add(big_integer_array({-1, 2, -(big_integer(1) << 100), 7}));
+  EXPECT_EQ(0, a[0]);
+  EXPECT_EQ(0, a[1]);
+  EXPECT_EQ(0, a[2]);
+  EXPECT_EQ(7, a[3]);
+  EXPECT_EQ(1u, a.arena_size());
+
+  a.set(0, -(big_integer(3) << 64));
+  a.set(3, 5);
+  a.mul(-(1LL << 40));
+  EXPECT_EQ((big_integer(3) << 104), a[0]);
+  EXPECT_EQ(-(big_integer(5) << 40), a[3]);
+  EXPECT_EQ(1, a.compare(0, 3));
+  EXPECT_EQ(0, a.compare(1, 2));
+  EXPECT_EQ(std::vector<int>({1, -1, 0, -1}), a.compare(big_integer_array({-1, 1, 0, 0})));
+
+  a.sort();
+  EXPECT_EQ(-(big_integer(5) << 40), a[0]);
+  EXPECT_EQ(big_integer(3) << 104, a[3]);
+  a.compact();
+  EXPECT_EQ(6u, a.arena_size());
+  EXPECT_EQ(big_integer(3) << 104, a[3]);
+  EXPECT_THROW(a.add(big_integer_array()), std::invalid_argument);
+}
+
+TEST(correctness_random, big_integer_array) {
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    std::vector<big_integer> x, y;
+    for (size_t i = 0; i != 500; ++i) {
+      x.push_back(rand_big(rand() % 6) * (rand() % 3 - 1));
+      y.push_back(rand_big(rand() % 6) * (rand() % 3 - 1));
+    }
+    big_integer_array a(x), b(y);
+    for (size_t i = 0; i != 50; ++i) {
+      size_t j = rand() % x.size();
+      x[j] = rand_big(rand() % 8) - rand_big(3);
+      a.set(j, x[j]);
+    }
+    a.add(b);
+    long long m = static_cast<long long>(myrand()) * (itn % 2 == 0 ? -myrand() : 3);
+    a.mul(m);
+    for (size_t i = 0; i != x.size(); ++i) {
+      x[i] = (x[i] + y[i]) * m;
+      EXPECT_EQ(x[i], a[i]);
+    }
+    std::vector<int> signs = a.compare(b);
+    for (size_t i = 0; i != x.size(); ++i)
+      EXPECT_EQ(x[i] < y[i] ? -1 : x[i] > y[i] ? 1 : 0, signs[i]);
+    if (itn % 2 == 0)
+      a.compact();
+    a.sort();
+    std::sort(x.begin(), x.end());
+    for (size_t i = 0; i != x.size(); ++i)
+      EXPECT_EQ(x[i], a[i]);
+  }
+}
+
+TEST(correctness, powmod) {
+  EXPECT_EQ(445, powmod(4, 13, 497));
+  EXPECT_EQ(1, powmod(-3, 0, 10));
+  EXPECT_EQ(0, powmod(5, 0, 1));
+  EXPECT_EQ(3, powmod(-3, 3, 10));
+  EXPECT_EQ(6, powmod(2, 100, -10));
+
+  big_integer p = (big_integer(1) << 127) - 1;
+  EXPECT_EQ(1, powmod(3, p - 1, p));
+  EXPECT_EQ(3, powmod(3, p, p));
+
+  EXPECT_THROW(powmod(2, -1, 7), std::invalid_argument);
+  EXPECT_THROW(powmod(2, 1, 0), std::invalid_argument);
+}
+
+TEST(correctness_random, powmod) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, e, m;
+    a.random(max_size / 2, rng);
+    e.random(200, rng);
+    m.random(max_size / 4, rng);
+    big_integer base(to_string(a)), exp(to_string(e)), mod(to_string(m));
+    if (exp < 0)
+      exp = -exp;
+    if (itn % 2 == 0)
+      mod |= 1;
+
+    big_integer expected = 1, square = base % mod;
+    for (big_integer rest = exp; rest != 0; rest /= 2) {
+      if (rest % 2 != 0)
+        expected = expected * square % mod;
+      square = square * square % mod;
+    }
+    if (expected < 0)
+      expected += mod < 0 ? -mod : mod;
+    EXPECT_EQ(expected, powmod(base, exp, mod));
+  }
+}
+
+TEST(correctness, gcd) {
+  EXPECT_EQ(6, gcd(-12, 18));
+  EXPECT_EQ(5, gcd(0, -5));
+  EXPECT_EQ(0, gcd(0, 0));
+
+  std::vector<big_integer> fib(2, 1);
+  for (size_t i = 2; i != 1000; ++i)
+    fib.push_back(fib[i - 1] + fib[i - 2]);
+  EXPECT_EQ(fib[99], gcd(fib[299], fib[199]));
+  EXPECT_EQ(fib[3], gcd(fib[999], -fib[995]));
+
+  big_integer x, y;
+  big_integer g = xgcd(fib[998], fib[997], x, y);
+  EXPECT_EQ(1, g);
+  EXPECT_EQ(g, fib[998] * x + fib[997] * y);
+
+  // Past a thousand limbs, where the half-GCD rounds take over: b and a end
+  // as F(65000) and F(64999).
+  big_integer f13000, f52000, a = 1, b = 1;
+  for (size_t i = 2; i != 65000; ++i) {
+    big_integer t = a + b;
+    a = b;
+    b = t;
+    if (i == 12999)
+      f13000 = b;
+    if (i == 51999)
+      f52000 = b;
+  }
+  EXPECT_EQ(f13000, gcd(b, f52000));
+  g = xgcd(b, a, x, y);
+  EXPECT_EQ(1, g);
+  EXPECT_EQ(g, b * x + a * y);
+  big_integer c = f13000 + 1;
+  g = xgcd(-c * b, c * f52000, x, y);
+  EXPECT_EQ(c * f13000, g);
+  EXPECT_EQ(g, -c * b * x + c * f52000 * y);
+
+  EXPECT_EQ(4, invert(3, 11));
+  EXPECT_EQ(7, invert(-3, -11));
+  EXPECT_THROW(invert(6, 9), std::invalid_argument);
+}
+
+TEST(correctness_random, gcd) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b, c;
+    a.random(max_size, rng);
+    b.random(max_size / (itn + 1), rng);
+    c.random(max_size / 4, rng);
+    big_integer A = big_integer(to_string(a)) * big_integer(to_string(c));
+    big_integer B = big_integer(to_string(b)) * big_integer(to_string(c));
+
+    big_integer x, y;
+    big_integer g = xgcd(A, B, x, y);
+    EXPECT_EQ(g, gcd(A, B));
+    EXPECT_EQ(g, A * x + B * y);
+    EXPECT_EQ(0, A % g);
+    EXPECT_EQ(0, B % g);
+    EXPECT_EQ(1, gcd(A / g, B / g));
+
+    big_integer m = B / g;
+    EXPECT_EQ(0, (A / g * invert(A / g, m) - 1) % m);
+  }
+}
+
+TEST(correctness, iroot) {
+  EXPECT_EQ(0, isqrt(0));
+  EXPECT_EQ(1, isqrt(3));
+  EXPECT_EQ(2, isqrt(4));
+  EXPECT_EQ(big_integer("4294967295"), isqrt(big_integer("18446744073709551615")));
+  EXPECT_EQ(big_integer("4294967296"), isqrt(big_integer("18446744073709551616")));
+  EXPECT_EQ(-3, iroot(-27, 3));
+  EXPECT_EQ(-2, iroot(-26, 3));
+  EXPECT_EQ(7, iroot(7, 1));
+  EXPECT_EQ(big_integer(1) << 100, iroot(big_integer(1) << 700, 7));
+  EXPECT_EQ((big_integer(1) << 100) - 1, iroot((big_integer(1) << 700) - 1, 7));
+  EXPECT_EQ(3, iroot(big_integer(1) << 65, 33));
+  EXPECT_EQ(3, iroot(big_integer(1) << 65, 34));
+  EXPECT_EQ(2, iroot(big_integer(1) << 65, 42));
+  EXPECT_EQ(1, iroot(big_integer(1) << 65, 66));
+  EXPECT_EQ(2, iroot((big_integer(1) << 1000) - 1, 999));
+  EXPECT_EQ(1, iroot((big_integer(1) << 1000) - 1, 1000));
+  EXPECT_EQ(-1, iroot(-(big_integer(1) << 300), 301));
+  for (unsigned k = 34; k <= 200; ++k) {
+    big_integer a = big_integer(1) << 65, r = iroot(a, k);
+    EXPECT_LE(pow(r, k), a);
+    EXPECT_GT(pow(r + 1, k), a);
+  }
+  for (int bits = 65; bits <= 300; bits += 47) {
+    big_integer a = (big_integer(1) << bits) - 1;
+    for (unsigned k = bits / 3; k <= static_cast<unsigned>(bits) + 1; ++k) {
+      big_integer r = iroot(a, k);
+      EXPECT_LE(pow(r, k), a);
+      EXPECT_GT(pow(r + 1, k), a);
+    }
+  }
+
+  EXPECT_THROW(isqrt(-1), std::invalid_argument);
+  EXPECT_THROW(iroot(5, 0), std::invalid_argument);
+}
+
+TEST(correctness_random, iroot) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size * 4, rng);
+    big_integer A(to_string(a));
+    if (A < 0)
+      A = -A;
+    for (unsigned k = 2; k != 6; ++k) {
+      big_integer r = iroot(A, k);
+      big_integer lo = 1, hi = 1;
+      for (unsigned i = 0; i != k; ++i) {
+        lo *= r;
+        hi *= r + 1;
+      }
+      EXPECT_LE(lo, A);
+      EXPECT_GT(hi, A);
+    }
+  }
+}
+
+TEST(correctness, pow) {
+  EXPECT_EQ(1, pow(big_integer(0), 0));
+  EXPECT_EQ(0, pow(big_integer(0), 5));
+  EXPECT_EQ(-1, pow(big_integer(-1), 3));
+  EXPECT_EQ(1024, pow(big_integer(2), 10));
+  EXPECT_EQ(-(big_integer(1) << 305), pow(big_integer(-8), 101) * 4);
+  EXPECT_EQ(big_integer("515377520732011331036461129765621272702107522001"), pow(big_integer(3), 100));
+  EXPECT_EQ(big_integer("-1000000000000000000000000000000000000000000000000000"), pow(big_integer(-100), 25) * 10);
+  EXPECT_EQ(pow(big_integer(3), 100) * pow(big_integer(3), 100), pow(pow(big_integer(3), 100), 2));
+}
+
+TEST(correctness_random, pow) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(itn * 37 + 1, rng);
+    big_integer A(to_string(a));
+    uint64_t exp = rng() % 200;
+    big_integer expected = 1;
+    for (uint64_t i = 0; i != exp; ++i)
+      expected *= A;
+    EXPECT_EQ(expected, pow(A, exp));
+  }
+}
+
+TEST(correctness, product) {
+  std::vector<big_integer> empty;
+  EXPECT_EQ(1, product(empty.begin(), empty.end()));
+
+  std::vector<big_integer> x;
+  big_integer expected = 1;
+  for (size_t i = 0; i != number_of_multipliers; ++i) {
+    x.push_back(myrand());
+    expected *= x.back();
+  }
+  EXPECT_EQ(expected, product(x.begin(), x.end()));
+}
+
+TEST(correctness, factorial) {
+  EXPECT_EQ(1, factorial(0));
+  EXPECT_EQ(1, factorial(1));
+  EXPECT_EQ(big_integer("2432902008176640000"), factorial(20));
+
+  big_integer expected = 1;
+  for (uint32_t i = 1; i != 3000; ++i) {
+    expected *= i;
+    if (i % 499 == 0) {
+      EXPECT_EQ(expected, factorial(i));
+    }
+  }
+}
+
+TEST(correctness, binomial) {
+  EXPECT_EQ(1, binomial(0, 0));
+  EXPECT_EQ(0, binomial(3, 4));
+  EXPECT_EQ(10, binomial(5, 2));
+  EXPECT_EQ(big_integer("100891344545564193334812497256"), binomial(100, 50));
+  big_integer top = UINT32_MAX;
+  EXPECT_EQ(1, binomial(UINT32_MAX, 0));
+  EXPECT_EQ(top, binomial(UINT32_MAX, 1));
+  EXPECT_EQ(top * (top - 1) / 2, binomial(UINT32_MAX, UINT32_MAX - 2));
+  EXPECT_EQ(big_integer(4000000000u) * 3999999999u / 2, binomial(4000000000u, 2));
+  big_integer falling = 1;
+  for (uint32_t k = 1; k <= 40; ++k) {
+    falling = falling * (top - k + 1) / k;
+    EXPECT_EQ(falling, binomial(UINT32_MAX, k));
+  }
+
+  std::vector<big_integer> row(1, 1);
+  for (uint32_t n = 1; n != 300; ++n) {
+    for (size_t k = row.size() - 1; k != 0; --k)
+      row[k] += row[k - 1];
+    row.push_back(1);
+    if (n % 37 == 0) {
+      for (uint32_t k = 0; k <= n; ++k)
+        EXPECT_EQ(row[k], binomial(n, k));
+    }
+  }
+}
+
+TEST(correctness_random, mul_large) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(max_size * (itn + 1) * 4, rng);
+    b.random(max_size * (itn % 3 + 1) * 3, rng);
+    big_integer A(to_string(a)), B(to_string(b));
+    EXPECT_EQ(to_string(a * b), to_string(A * B));
+    EXPECT_EQ(to_string(a * a), to_string(A * A));
+  }
+}
+
+TEST(correctness, int64_boundaries) {
+  big_integer max = (big_integer(1) << 63) - 1, min = -max - 1;
+  EXPECT_EQ(big_integer("9223372036854775808"), max + 1);
+  EXPECT_EQ(big_integer("-9223372036854775809"), min - 1);
+  EXPECT_EQ(big_integer("9223372036854775808"), min / -1);
+  EXPECT_EQ(0, min % -1);
+  EXPECT_EQ(big_integer("18446744073709551615"), max * 2 + 1);
+  EXPECT_EQ(big_integer("85070591730234615847396907784232501249"), max * max);
+  EXPECT_EQ(big_integer("-85070591730234615856620279821087277056"), max * min);
+  EXPECT_EQ(-1, (max + 1) * -1 - min - 1);
+  EXPECT_TRUE(min < max);
+  EXPECT_TRUE(min - 1 < min);
+  EXPECT_TRUE(max < max + 1);
+  EXPECT_EQ(big_integer(-3), big_integer(-20) / 6);
+  EXPECT_EQ(big_integer(-2), big_integer(-20) % 6);
+  EXPECT_THROW(big_integer(1) / 0, std::invalid_argument);
+}
+
+TEST(correctness_random, small_values) {
+  std::default_random_engine rng(7);
+  std::uniform_int_distribution<int> bits(0, 63);
+  for (size_t itn = 0; itn != number_of_iterations * 1000; ++itn) {
+    big_integer_gmp a = big_integer_gmp(myrand()) << bits(rng), b = big_integer_gmp(myrand()) >> bits(rng) % 31;
+    big_integer A(to_string(a)), B(to_string(b));
+    EXPECT_EQ(to_string(a + b), to_string(A + B));
+    EXPECT_EQ(to_string(a - b), to_string(A - B));
+    EXPECT_EQ(to_string(a * b), to_string(A * B));
+    if (b != 0) {
+      EXPECT_EQ(to_string(a / b), to_string(A / B));
+      EXPECT_EQ(to_string(a % b), to_string(A % B));
+    }
+    EXPECT_EQ(a < b, A < B);
+  }
+}
+
+TEST(correctness, scalar_operands) {
+  big_integer a("123456789012345678901234567890");
+  EXPECT_EQ(big_integer("123456789012345678901234567897"), a + 7);
+  EXPECT_EQ(big_integer("123456789012345678901234567883"), a - 7L);
+  EXPECT_EQ(big_integer("-123456789012345678901234567883"), 7LL - a);
+  EXPECT_EQ(big_integer("2277375791072698140124934049010216029110176642350"), a * UINT64_C(18446744073709551615));
+  EXPECT_EQ(big_integer("-13385211885"), a / INT64_MIN);
+  EXPECT_EQ(big_integer("-12345678901234567890123456789"), -a / 10u);
+  EXPECT_EQ(-8, (-a - 8) % 13);
+  EXPECT_EQ(4, 100 % big_integer(-32));
+  EXPECT_EQ(3, 100u / big_integer(32));
+  EXPECT_EQ(big_integer("18446744073709551615"), big_integer(UINT64_MAX));
+  EXPECT_EQ(big_integer("-9223372036854775808"), big_integer(INT64_MIN));
+  EXPECT_TRUE(big_integer(UINT64_MAX) == UINT64_MAX);
+  EXPECT_TRUE(big_integer(INT64_MIN) < -1);
+  EXPECT_TRUE(-a < INT64_MIN);
+  EXPECT_TRUE(UINT64_MAX < a);
+  EXPECT_TRUE(0u >= big_integer(0));
+  EXPECT_THROW(a / 0u, std::invalid_argument);
+  EXPECT_THROW(a % 0L, std::invalid_argument);
+}
+
+TEST(correctness_random, scalar_operands) {
+  std::mt19937_64 rng(35);
+  for (size_t itn = 0; itn != number_of_iterations * 300; ++itn) {
+    big_integer a = rand_big(itn % 10 + 1);
+    uint64_t u = rng() >> (rng() % 64);
+    int64_t s = static_cast<int64_t>(rng()) >> (rng() % 64);
+    big_integer U(std::to_string(u)), S(std::to_string(s));
+    EXPECT_EQ(a + U, a + u);
+    EXPECT_EQ(a - S, a - s);
+    EXPECT_EQ(S - a, s - a);
+    EXPECT_EQ(a * U, a * u);
+    EXPECT_EQ(a * S, a * s);
+    if (s != 0) {
+      EXPECT_EQ(a / S, a / s);
+      EXPECT_EQ(a % S, a % s);
+    }
+    if (u != 0) {
+      EXPECT_EQ(a / U, a / u);
+      EXPECT_EQ(a % U, a % u);
+    }
+    EXPECT_EQ(a < S, a < s);
+    EXPECT_EQ(S < a, s < a);
+    EXPECT_EQ(a == U, a == u);
+  }
+}
+
+TEST(correctness, fixed_width) {
+  typedef big_uint<128> u128;
+  typedef big_int<128> i128;
+  u128 max = ~u128();
+  EXPECT_EQ(u128(), max + 1);
+  EXPECT_EQ(max, u128() - 1);
+  EXPECT_EQ(big_integer("340282366920938463463374607431768211455"), static_cast<big_integer>(max));
+  EXPECT_EQ(u128(1) << 127, u128(big_integer(1) << 127));
+  EXPECT_EQ(max, u128(big_integer(-1)));
+  EXPECT_EQ(i128(-7), i128(-20) / 3 * 1 - 1);
+  EXPECT_EQ(i128(-2), i128(-20) % 3);
+  EXPECT_EQ(i128(-3), i128(-20) >> 3);
+  EXPECT_TRUE(i128(-1) < i128(0));
+  EXPECT_EQ(big_integer(-5), static_cast<big_integer>(i128(-5)));
+
+  typedef big_uint<128, overflow::check> c128;
+  EXPECT_THROW(~c128() + 1, std::overflow_error);
+  EXPECT_THROW(c128() - 1, std::overflow_error);
+  EXPECT_THROW((c128(1) << 64) * (c128(1) << 64), std::overflow_error);
+  EXPECT_THROW(c128(1) << 128, std::overflow_error);
+  EXPECT_THROW(c128(big_integer(1) << 128), std::overflow_error);
+  EXPECT_EQ(c128(1) << 127, (c128(1) << 63) * (c128(1) << 64));
+  EXPECT_THROW(c128(1) / c128(), std::invalid_argument);
+
+  typedef big_int<128, overflow::check> s128;
+  s128 smin(-(big_integer(1) << 127));
+  EXPECT_THROW(smin - 1, std::overflow_error);
+  EXPECT_THROW(-smin, std::overflow_error);
+  EXPECT_THROW(smin / -1, std::overflow_error);
+  EXPECT_THROW(s128(big_integer(1) << 127), std::overflow_error);
+  EXPECT_THROW((s128(1) << 100) * (s128(1) << 40), std::overflow_error);
+  EXPECT_EQ(smin, s128(-1) * (s128(1) << 63) * (s128(1) << 64));
+  EXPECT_THROW(s128(1) << 127, std::overflow_error);
+  EXPECT_THROW((s128(1) << 126) << 1, std::overflow_error);
+  EXPECT_THROW(s128(3) << 126, std::overflow_error);
+  EXPECT_THROW(s128(-3) << 126, std::overflow_error);
+  EXPECT_THROW(s128(-1) << 128, std::overflow_error);
+  EXPECT_EQ(smin, s128(-1) << 127);
+  EXPECT_EQ(s128(-2) << 125, s128(-1) << 126);
+  EXPECT_EQ(s128(), s128() << 200);
+  EXPECT_EQ(i128(1) << 127, i128(big_integer(1) << 126) << 1);
+}
+
+TEST(correctness, lane_batch) {
+  typedef big_uint<128> u128;
+  big_uint_lanes<128, 4> a, b;
+  a.set(0, u128(UINT64_MAX));
+  b.set(0, u128(1));
+  a.set(1, u128(0));
+  b.set(1, u128(1));
+  a.set(2, u128(7));
+  b.set(2, u128(7));
+  a.set(3, u128(1) << 100);
+  b.set(3, u128(3) << 30);
+  big_uint_lanes<128, 4> s = a + b, d = a - b, p = a * b;
+  EXPECT_EQ(u128(1) << 64, s.get(0));
+  EXPECT_EQ(u128(UINT64_MAX - 1), d.get(0));
+  EXPECT_EQ(-u128(1), d.get(1));
+  EXPECT_EQ(u128(49), p.get(2));
+  EXPECT_EQ(u128(0), p.get(3));
+  std::array<int, 4> c = compare(a, b);
+  EXPECT_EQ(1, c[0]);
+  EXPECT_EQ(-1, c[1]);
+  EXPECT_EQ(0, c[2]);
+  EXPECT_EQ(1, c[3]);
+}
+
+TEST(correctness, lane_batch_target) {
+  std::string target = lane_batch_target();
+#ifdef BIGINT_LANE_CLONES
+  __builtin_cpu_init();
+  EXPECT_EQ(__builtin_cpu_supports("avx512f") ? "avx512f" : __builtin_cpu_supports("avx2") ? "avx2" : "default", target);
+#else
+  EXPECT_EQ("default", target);
+#endif
+
+  // Sixteen lanes fill the widest vectors, so this runs the kernels the
+  // loader chose for this processor.
+  big_uint_lanes<256, 16> x, y;
+  std::vector<big_uint<256>> a, b;
+  for (size_t l = 0; l < 16; l++) {
+    a.push_back(big_uint<256>(rand_big(l % 9 + 1)));
+    b.push_back(l % 4 == 0 ? a.back() : big_uint<256>(rand_big(l % 7 + 1)));
+    x.set(l, a.back());
+    y.set(l, b.back());
+  }
+  big_uint_lanes<256, 16> s = x + y, d = x - y, p = x * y;
+  std::array<int, 16> c = compare(x, y);
+  for (size_t l = 0; l < 16; l++) {
+    EXPECT_EQ(a[l] + b[l], s.get(l));
+    EXPECT_EQ(a[l] - b[l], d.get(l));
+    EXPECT_EQ(a[l] * b[l], p.get(l));
+    EXPECT_EQ((b[l] < a[l]) - (a[l] < b[l]), c[l]);
+  }
+}
+
+TEST(correctness, fixed_width_literal) {
+  constexpr big_uint<256> primes[] = {
+    big_uint<256>(115792089237316195423570985008687907853269984665640564039457584007908834671663_bi),
+    big_uint<256>(0xFFFFFFFF00000001000000000000000000000000FFFFFFFFFFFFFFFFFFFFFFFF_bi),
+  };
+  static_assert(primes[1] % 10 == 1, "folded at compile time");
+  static_assert(12345678901234567890123_bi / 1000 == 12345678901234567890_bi, "folded at compile time");
+  static_assert(sizeof(0xFFFFFFFFFFFFFFFF_bi) == 8, "capacity follows the digit count");
+
+  EXPECT_EQ(big_integer("115792089237316195423570985008687907853269984665640564039457584007908834671663"),
+            static_cast<big_integer>(primes[0]));
+  EXPECT_EQ((big_integer(1) << 256) - (big_integer(1) << 224) + (big_integer(1) << 192) + (big_integer(1) << 96) - 1,
+            static_cast<big_integer>(primes[1]));
+  EXPECT_EQ(big_integer(511), static_cast<big_integer>(0777_bi));
+  EXPECT_EQ(big_integer(10), static_cast<big_integer>(0b1010_bi));
+  EXPECT_EQ(big_integer(1000000), static_cast<big_integer>(1'000'000_bi));
+  EXPECT_EQ(big_integer(0), static_cast<big_integer>(0_bi));
+}
+
+TEST(correctness_random, fixed_width) {
+  big_integer mod = big_integer(1) << 256;
+  for (size_t itn = 0; itn != number_of_iterations * 100; ++itn) {
+    big_integer a = rand_big(itn % 9 + 1), b = rand_big(itn % 7 + 1);
+    big_integer ua = (a % mod + mod) % mod, ub = (b % mod + mod) % mod;
+    big_uint<256> x(a), y(b);
+    EXPECT_EQ(ua, static_cast<big_integer>(x));
+    EXPECT_EQ((ua + ub) % mod, static_cast<big_integer>(x + y));
+    EXPECT_EQ(((ua - ub) % mod + mod) % mod, static_cast<big_integer>(x - y));
+    EXPECT_EQ(ua * ub % mod, static_cast<big_integer>(x * y));
+    if (ub != 0) {
+      EXPECT_EQ(ua / ub, static_cast<big_integer>(x / y));
+      EXPECT_EQ(ua % ub, static_cast<big_integer>(x % y));
+    }
+    EXPECT_EQ(ua < ub, x < y);
+
+    big_integer sa = a >> 8, sb = b >> 4;
+    if (sa < (mod >> 1) && sa >= -(mod >> 1) && sb != 0) {
+      big_int<256> p(sa), q(sb);
+      EXPECT_EQ(sa / sb, static_cast<big_integer>(p / q));
+      EXPECT_EQ(sa % sb, static_cast<big_integer>(p % q));
+      EXPECT_EQ(sa < sb, p < q);
+    }
+  }
+}
+
+TEST(correctness_random, lane_batch) {
+  big_integer mod = big_integer(1) << 256;
+  for (size_t itn = 0; itn != number_of_iterations * 10; ++itn) {
+    big_uint_lanes<256, 8> x, y;
+    big_integer ua[8], ub[8];
+    for (size_t l = 0; l < 8; l++) {
+      big_integer a = rand_big((itn + l) % 9 + 1), b = rand_big((itn * 3 + l) % 7 + 1);
+      if (l == itn % 8) {
+        b = a;
+      }
+      ua[l] = (a % mod + mod) % mod;
+      ub[l] = (b % mod + mod) % mod;
+      x.set(l, big_uint<256>(a));
+      y.set(l, big_uint<256>(b));
+    }
+    big_uint_lanes<256, 8> s = x + y, d = x - y, p = x * y;
+    std::array<int, 8> c = compare(x, y);
+    for (size_t l = 0; l < 8; l++) {
+      EXPECT_EQ(ua[l], static_cast<big_integer>(x.get(l)));
+      EXPECT_EQ((ua[l] + ub[l]) % mod, static_cast<big_integer>(s.get(l)));
+      EXPECT_EQ(((ua[l] - ub[l]) % mod + mod) % mod, static_cast<big_integer>(d.get(l)));
+      EXPECT_EQ(ua[l] * ub[l] % mod, static_cast<big_integer>(p.get(l)));
+      EXPECT_EQ((ua[l] > ub[l]) - (ua[l] < ub[l]), c[l]);
+    }
+  }
+}
+
 TEST(correctness_random, bitwise) {
   std::default_random_engine rng(42);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
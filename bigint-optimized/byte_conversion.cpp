@@ -0,0 +1,107 @@
+#include "byte_conversion.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "limb_arithmetic.h"
+
+namespace {
+
+bool const HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+void check_word_size(size_t word_size) {
+    if (word_size == 0) {
+        throw std::invalid_argument("invalid word size");
+    }
+}
+
+bool little_endian(byte_order endian) {
+    return endian == byte_order::little || (endian == byte_order::native && HOST_LITTLE_ENDIAN);
+}
+
+// The offset in the encoding of byte k of the magnitude, counting from the
+// least significant one.
+class byte_layout {
+public:
+    byte_layout(size_t count, size_t word_size, word_order order, byte_order endian)
+        : count(count)
+        , word_size(word_size)
+        , msw_first(order == word_order::most_significant_first)
+        , big_endian(!little_endian(endian)) {}
+
+    // Whether the encoding is the magnitude's bytes from the least
+    // significant up, which is how the limbs sit in memory on this host.
+    bool matches_limbs() const {
+        return HOST_LITTLE_ENDIAN && !big_endian && (!msw_first || count == 1);
+    }
+
+    size_t offset(size_t word, size_t byte) const {
+        return (msw_first ? count - 1 - word : word) * word_size + (big_endian ? word_size - 1 - byte : byte);
+    }
+
+private:
+    size_t count;
+    size_t word_size;
+    bool msw_first;
+    bool big_endian;
+};
+
+}
+
+size_t export_words(big_integer const& a, size_t word_size) {
+    check_word_size(word_size);
+    size_t n = a.num.size();
+    uint32_t top = a.num[n - 1];
+    if (top == 0) {
+        return 0;
+    }
+    size_t bytes = (n - 1) * 4 + (32 - leading_zeros(top) + 7) / 8;
+    return (bytes + word_size - 1) / word_size;
+}
+
+size_t export_bytes(void* out, big_integer const& a, size_t word_size,
+                    word_order order, byte_order endian) {
+    size_t count = export_words(a, word_size);
+    if (count == 0) {
+        return 0;
+    }
+    uint32_t const* limbs = a.num.data();
+    size_t size = std::min(a.num.size() * 4, count * word_size);
+    unsigned char* p = static_cast<unsigned char*>(out);
+    byte_layout layout(count, word_size, order, endian);
+    if (layout.matches_limbs()) {
+        std::memcpy(p, limbs, size);
+        std::fill(p + size, p + count * word_size, 0);
+        return count;
+    }
+    for (size_t w = 0, k = 0; w < count; w++) {
+        for (size_t b = 0; b < word_size; b++, k++) {
+            p[layout.offset(w, b)] = k < size ? static_cast<unsigned char>(limbs[k / 4] >> (k % 4 * 8)) : 0;
+        }
+    }
+    return count;
+}
+
+big_integer import_bytes(void const* in, size_t count, size_t word_size,
+                         word_order order, byte_order endian) {
+    check_word_size(word_size);
+    size_t size = count * word_size;
+    if (size == 0) {
+        return 0;
+    }
+    std::vector<uint32_t> limbs((size + 3) / 4);
+    unsigned char const* p = static_cast<unsigned char const*>(in);
+    byte_layout layout(count, word_size, order, endian);
+    if (layout.matches_limbs()) {
+        std::memcpy(limbs.data(), p, size);
+    } else {
+        for (size_t w = 0, k = 0; w < count; w++) {
+            for (size_t b = 0; b < word_size; b++, k++) {
+                limbs[k / 4] |= static_cast<uint32_t>(p[layout.offset(w, b)]) << (k % 4 * 8);
+            }
+        }
+    }
+    return from_limbs(std::move(limbs), false);
+}
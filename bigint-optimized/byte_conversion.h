@@ -0,0 +1,34 @@
+#ifndef BIGINT_BYTE_CONVERSION_H
+#define BIGINT_BYTE_CONVERSION_H
+
+#include <cstddef>
+#include "big_integer.h"
+
+// Binary conversion of magnitudes in the manner of mpz_export and
+// mpz_import: the value is a sequence of words of word_size bytes, with the
+// order of the words and of the bytes inside each word chosen separately.
+// The sign is not part of the encoding.
+enum class word_order {
+    most_significant_first,
+    least_significant_first,
+};
+
+enum class byte_order {
+    big,
+    little,
+    native,
+};
+
+// The number of words export_bytes writes for a, 0 when a is zero.
+size_t export_words(big_integer const& a, size_t word_size);
+
+// Writes |a| to out as export_words(a, word_size) words and returns that
+// count. The most significant word is zero-padded.
+size_t export_bytes(void* out, big_integer const& a, size_t word_size,
+                    word_order order, byte_order endian);
+
+// Reads count words from in as a non-negative value.
+big_integer import_bytes(void const* in, size_t count, size_t word_size,
+                         word_order order, byte_order endian);
+
+#endif //BIGINT_BYTE_CONVERSION_H
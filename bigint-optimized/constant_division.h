@@ -0,0 +1,131 @@
+#ifndef BIGINT_CONSTANT_DIVISION_H
+#define BIGINT_CONSTANT_DIVISION_H
+
+#include <cstddef>
+#include <cstdint>
+#include "big_integer.h"
+
+// Remainders and divisibility tests by a divisor fixed at compile time. Every
+// constant the loops need (masks, inverses, which folding identity applies)
+// is derived by the compiler from D, so a call is a single pass over the
+// limbs with no division instruction in it.
+namespace constant_division_detail {
+
+constexpr uint32_t low_bit(uint32_t d) {
+    return d & (0 - d);
+}
+
+// Inverse of an odd d modulo 2^32, by Newton iteration.
+constexpr uint32_t binvert(uint32_t d) {
+    uint32_t inv = d;
+    for (int i = 0; i < 4; i++) {
+        inv *= 2 - d * inv;
+    }
+    return inv;
+}
+
+// 2^(32k) mod d.
+constexpr uint64_t limb_power(uint32_t d, int k) {
+    uint64_t p = 1 % d;
+    for (int i = 0; i < k; i++) {
+        p = (p << 32) % d;
+    }
+    return p;
+}
+
+// 2^32 == 1 (mod d): the limbs can simply be added.
+inline uint64_t fold_sum(uint32_t const* a, size_t n, uint32_t d) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i];
+    }
+    return sum % d;
+}
+
+// 2^32 == -1 (mod d): the limbs are added with alternating signs.
+inline uint64_t fold_alternating(uint32_t const* a, size_t n, uint32_t d) {
+    uint64_t even = 0, odd = 0;
+    for (size_t i = 0; i < n; i += 2) {
+        even += a[i];
+    }
+    for (size_t i = 1; i < n; i += 2) {
+        odd += a[i];
+    }
+    return (even % d + d - odd % d) % d;
+}
+
+// Hensel reduction of an odd d: returns c in [0, d] with a == c * 2^(32n)
+// (mod d), so d divides a exactly when c is 0 or d.
+inline uint32_t modexact(uint32_t const* a, size_t n, uint32_t d, uint32_t inv) {
+    uint32_t c = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t x = a[i] - c;
+        uint32_t borrow = a[i] < c;
+        uint32_t q = x * inv;
+        c = static_cast<uint32_t>((static_cast<uint64_t>(q) * d) >> 32) + borrow;
+    }
+    return c;
+}
+
+}
+
+// |x| mod D, the magnitude of x % D.
+template <uint32_t D>
+uint32_t mod_const(big_integer const& x) {
+    static_assert(D != 0, "division by zero");
+    uint32_t const* a = x.num.data();
+    size_t n = x.num.size();
+    if ((D & (D - 1)) == 0) {
+        return a[0] & (D - 1);
+    }
+    if (UINT32_MAX % D == 0) {
+        return static_cast<uint32_t>(constant_division_detail::fold_sum(a, n, D));
+    }
+    if ((static_cast<uint64_t>(UINT32_MAX) + 2) % D == 0) {
+        return static_cast<uint32_t>(constant_division_detail::fold_alternating(a, n, D));
+    }
+    // Horner's rule, four limbs per step for divisors small enough that the
+    // weighted sum fits in 64 bits; the compiler turns % by the constant D
+    // into a multiply by its reciprocal.
+    uint64_t r = 0;
+    size_t i = n;
+    if (D < (1U << 29)) {
+        constexpr uint64_t p1 = constant_division_detail::limb_power(D, 1);
+        constexpr uint64_t p2 = constant_division_detail::limb_power(D, 2);
+        constexpr uint64_t p3 = constant_division_detail::limb_power(D, 3);
+        constexpr uint64_t p4 = constant_division_detail::limb_power(D, 4);
+        for (; i >= 4; i -= 4) {
+            r = (r * p4 + a[i - 1] * p3 + a[i - 2] * p2 + a[i - 3] * p1 + a[i - 4]) % D;
+        }
+    }
+    for (; i-- > 0;) {
+        r = ((r << 32) | a[i]) % D;
+    }
+    return static_cast<uint32_t>(r);
+}
+
+// x % D == 0. The power of two in D is a mask on the low limb; the odd part
+// goes through mod_const when that has a fast path for it and through Hensel
+// reduction with its inverse modulo 2^32 otherwise.
+template <uint32_t D>
+bool divisible_by(big_integer const& x) {
+    static_assert(D != 0, "division by zero");
+    constexpr uint32_t low = constant_division_detail::low_bit(D);
+    constexpr uint32_t odd = D / low;
+    uint32_t const* a = x.num.data();
+    size_t n = x.num.size();
+    if ((a[0] & (low - 1)) != 0) {
+        return false;
+    }
+    if (odd == 1) {
+        return true;
+    }
+    if (odd < (1U << 29) || UINT32_MAX % odd == 0) {
+        return mod_const<odd>(x) == 0;
+    }
+    constexpr uint32_t inv = constant_division_detail::binvert(odd);
+    uint32_t c = constant_division_detail::modexact(a, n, odd, inv);
+    return c == 0 || c == odd;
+}
+
+#endif //BIGINT_CONSTANT_DIVISION_H
@@ -0,0 +1,602 @@
+#ifndef BIGINT_FIXED_WIDTH_H
+#define BIGINT_FIXED_WIDTH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "big_integer.h"
+#include "limb_arithmetic.h"
+
+// Integers of a width known at compile time (128, 256, 512 bits, ...). The
+// limbs are a plain array inside the object, every loop has a constant trip
+// count the compiler can unroll, and nothing is allocated. Arithmetic either
+// wraps modulo 2^Bits or, with overflow::check, throws std::overflow_error.
+enum class overflow {
+    wrap,
+    check
+};
+
+template <size_t Bits, overflow Mode = overflow::wrap>
+struct big_uint {
+    static_assert(Bits >= 64 && Bits % 32 == 0, "width must be a multiple of 32 bits, at least 64");
+    static const size_t LIMBS = Bits / 32;
+
+    uint32_t limb[LIMBS];
+
+    constexpr big_uint()
+        : limb() {}
+
+    constexpr big_uint(uint64_t a)
+        : limb() {
+        limb[0] = static_cast<uint32_t>(a);
+        limb[1] = static_cast<uint32_t>(a >> 32);
+    }
+
+    // Between widths and modes; narrowing wraps, or throws in check mode.
+    template <size_t OtherBits, overflow OtherMode>
+    constexpr explicit big_uint(big_uint<OtherBits, OtherMode> const& a)
+        : limb() {
+        for (size_t i = 0; i < a.LIMBS; i++) {
+            if (i < LIMBS) {
+                limb[i] = a.limb[i];
+            } else {
+                check(a.limb[i] == 0);
+            }
+        }
+    }
+
+    // Negative or too wide values wrap modulo 2^Bits, or throw in check mode.
+    explicit big_uint(big_integer const& a)
+        : limb() {
+        size_t n = a.num.size();
+        uint32_t const* src = a.num.data();
+        for (size_t i = LIMBS; i < n; i++) {
+            check(src[i] == 0);
+        }
+        check(!a.sign);
+        for (size_t i = 0; i < LIMBS && i < n; i++) {
+            limb[i] = src[i];
+        }
+        if (a.sign) {
+            *this = -*this;
+        }
+    }
+
+    explicit operator big_integer() const {
+        return from_limbs(std::vector<uint32_t>(limb, limb + LIMBS), false);
+    }
+
+    constexpr big_uint& operator+=(big_uint const& rhs) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            carry += static_cast<uint64_t>(limb[i]) + rhs.limb[i];
+            limb[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        check(carry == 0);
+        return *this;
+    }
+
+    constexpr big_uint& operator-=(big_uint const& rhs) {
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t c = static_cast<uint64_t>(limb[i]) - rhs.limb[i] - borrow;
+            limb[i] = static_cast<uint32_t>(c);
+            borrow = static_cast<uint32_t>(c >> 32) & 1U;
+        }
+        check(borrow == 0);
+        return *this;
+    }
+
+    // Only the product limbs below 2^Bits are formed; check mode also looks
+    // at the carries and cross terms that would land above.
+    constexpr big_uint& operator*=(big_uint const& rhs) {
+        uint32_t res[LIMBS] = {};
+        bool lost = false;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < LIMBS; j++) {
+                carry += static_cast<uint64_t>(limb[i]) * rhs.limb[j] + res[i + j];
+                res[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            if (Mode == overflow::check && limb[i] != 0) {
+                lost |= carry != 0;
+                for (size_t j = LIMBS - i; j < LIMBS; j++) {
+                    lost |= rhs.limb[j] != 0;
+                }
+            }
+        }
+        check(!lost);
+        for (size_t i = 0; i < LIMBS; i++) {
+            limb[i] = res[i];
+        }
+        return *this;
+    }
+
+    constexpr big_uint& operator/=(big_uint const& rhs) {
+        big_uint r;
+        divmod(*this, rhs, *this, r);
+        return *this;
+    }
+
+    constexpr big_uint& operator%=(big_uint const& rhs) {
+        big_uint q;
+        divmod(*this, rhs, q, *this);
+        return *this;
+    }
+
+    constexpr big_uint& operator&=(big_uint const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limb[i] &= rhs.limb[i];
+        }
+        return *this;
+    }
+
+    constexpr big_uint& operator|=(big_uint const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limb[i] |= rhs.limb[i];
+        }
+        return *this;
+    }
+
+    constexpr big_uint& operator^=(big_uint const& rhs) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limb[i] ^= rhs.limb[i];
+        }
+        return *this;
+    }
+
+    constexpr big_uint& operator<<=(unsigned rhs) {
+        if (Mode == overflow::check && rhs != 0) {
+            check(rhs < Bits ? (*this >> (Bits - rhs)).is_zero() : is_zero());
+        }
+        size_t whole = rhs / 32;
+        unsigned cnt = rhs % 32;
+        for (size_t i = LIMBS; i-- > 0;) {
+            uint32_t hi = i >= whole ? limb[i - whole] : 0;
+            uint32_t lo = i > whole ? limb[i - whole - 1] : 0;
+            limb[i] = cnt == 0 ? hi : (hi << cnt) | (lo >> (32 - cnt));
+        }
+        return *this;
+    }
+
+    constexpr big_uint& operator>>=(unsigned rhs) {
+        size_t whole = rhs / 32;
+        unsigned cnt = rhs % 32;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint32_t lo = i + whole < LIMBS ? limb[i + whole] : 0;
+            uint32_t hi = i + whole + 1 < LIMBS ? limb[i + whole + 1] : 0;
+            limb[i] = cnt == 0 ? lo : (lo >> cnt) | (hi << (32 - cnt));
+        }
+        return *this;
+    }
+
+    constexpr big_uint operator~() const {
+        big_uint res;
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.limb[i] = ~limb[i];
+        }
+        return res;
+    }
+
+    constexpr big_uint operator-() const {
+        big_uint res = ~*this;
+        uint32_t carry = 1;
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.limb[i] += carry;
+            carry = carry && res.limb[i] == 0;
+        }
+        check(is_zero());
+        return res;
+    }
+
+    constexpr bool is_zero() const {
+        uint32_t acc = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            acc |= limb[i];
+        }
+        return acc == 0;
+    }
+
+    // Number of significant limbs, at least one.
+    constexpr size_t size() const {
+        size_t n = LIMBS;
+        while (n > 1 && limb[n - 1] == 0) {
+            n--;
+        }
+        return n;
+    }
+
+    // Knuth's algorithm D on stack buffers, single-limb divisors by short division.
+    constexpr static void divmod(big_uint const& a, big_uint const& b, big_uint& q, big_uint& r) {
+        size_t n = b.size(), m = a.size();
+        if (n == 1 && b.limb[0] == 0) {
+            throw std::invalid_argument("division by zero");
+        }
+        big_uint quot, rem;
+        if (m < n) {
+            r = a;
+            q = quot;
+            return;
+        }
+        if (n == 1) {
+            uint64_t k = 0;
+            for (size_t i = m; i-- > 0;) {
+                k = (k << 32) | a.limb[i];
+                quot.limb[i] = static_cast<uint32_t>(k / b.limb[0]);
+                k %= b.limb[0];
+            }
+            rem.limb[0] = static_cast<uint32_t>(k);
+            q = quot;
+            r = rem;
+            return;
+        }
+        unsigned s = 0;
+        while ((b.limb[n - 1] << s) >> 31 == 0) {
+            s++;
+        }
+        uint32_t vn[LIMBS] = {}, un[LIMBS + 1] = {};
+        for (size_t i = n; i-- > 0;) {
+            vn[i] = (b.limb[i] << s) | (s != 0 && i > 0 ? b.limb[i - 1] >> (32 - s) : 0);
+        }
+        un[m] = s != 0 ? a.limb[m - 1] >> (32 - s) : 0;
+        for (size_t i = m; i-- > 0;) {
+            un[i] = (a.limb[i] << s) | (s != 0 && i > 0 ? a.limb[i - 1] >> (32 - s) : 0);
+        }
+        for (size_t j = m - n + 1; j-- > 0;) {
+            uint64_t top = (static_cast<uint64_t>(un[j + n]) << 32) | un[j + n - 1];
+            uint64_t qhat = top / vn[n - 1], rhat = top % vn[n - 1];
+            while (qhat >> 32 != 0 || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                qhat--;
+                rhat += vn[n - 1];
+                if (rhat >> 32 != 0) {
+                    break;
+                }
+            }
+            int64_t t = 0;
+            uint64_t k = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint64_t p = qhat * vn[i];
+                t = static_cast<int64_t>(un[i + j]) - static_cast<int64_t>(k) - static_cast<int64_t>(p & 0xFFFFFFFFU);
+                un[i + j] = static_cast<uint32_t>(t);
+                k = (p >> 32) - static_cast<uint64_t>(t >> 32);
+            }
+            t = static_cast<int64_t>(un[j + n]) - static_cast<int64_t>(k);
+            un[j + n] = static_cast<uint32_t>(t);
+            quot.limb[j] = static_cast<uint32_t>(qhat);
+            if (t < 0) {
+                quot.limb[j]--;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; i++) {
+                    carry += static_cast<uint64_t>(un[i + j]) + vn[i];
+                    un[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                un[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            rem.limb[i] = (un[i] >> s) | (s != 0 ? un[i + 1] << (32 - s) : 0);
+        }
+        q = quot;
+        r = rem;
+    }
+
+    constexpr friend big_uint operator+(big_uint a, big_uint const& b) {
+        return a += b;
+    }
+
+    constexpr friend big_uint operator-(big_uint a, big_uint const& b) {
+        return a -= b;
+    }
+
+    constexpr friend big_uint operator*(big_uint a, big_uint const& b) {
+        return a *= b;
+    }
+
+    constexpr friend big_uint operator/(big_uint a, big_uint const& b) {
+        return a /= b;
+    }
+
+    constexpr friend big_uint operator%(big_uint a, big_uint const& b) {
+        return a %= b;
+    }
+
+    constexpr friend big_uint operator&(big_uint a, big_uint const& b) {
+        return a &= b;
+    }
+
+    constexpr friend big_uint operator|(big_uint a, big_uint const& b) {
+        return a |= b;
+    }
+
+    constexpr friend big_uint operator^(big_uint a, big_uint const& b) {
+        return a ^= b;
+    }
+
+    constexpr friend big_uint operator<<(big_uint a, unsigned b) {
+        return a <<= b;
+    }
+
+    constexpr friend big_uint operator>>(big_uint a, unsigned b) {
+        return a >>= b;
+    }
+
+    constexpr friend bool operator==(big_uint const& a, big_uint const& b) {
+        uint32_t diff = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            diff |= a.limb[i] ^ b.limb[i];
+        }
+        return diff == 0;
+    }
+
+    constexpr friend bool operator!=(big_uint const& a, big_uint const& b) {
+        return !(a == b);
+    }
+
+    constexpr friend bool operator<(big_uint const& a, big_uint const& b) {
+        for (size_t i = LIMBS; i-- > 0;) {
+            if (a.limb[i] != b.limb[i]) {
+                return a.limb[i] < b.limb[i];
+            }
+        }
+        return false;
+    }
+
+    constexpr friend bool operator>(big_uint const& a, big_uint const& b) {
+        return b < a;
+    }
+
+    constexpr friend bool operator<=(big_uint const& a, big_uint const& b) {
+        return !(b < a);
+    }
+
+    constexpr friend bool operator>=(big_uint const& a, big_uint const& b) {
+        return !(a < b);
+    }
+
+private:
+    constexpr static void check(bool ok) {
+        if (Mode == overflow::check && !ok) {
+            throw std::overflow_error("fixed-width integer overflow");
+        }
+    }
+};
+
+// Two's complement signed counterpart of big_uint; division truncates toward
+// zero like big_integer.
+template <size_t Bits, overflow Mode = overflow::wrap>
+struct big_int {
+    typedef big_uint<Bits, overflow::wrap> bits_type;
+
+    bits_type bits;
+
+    constexpr big_int() {}
+
+    constexpr big_int(int64_t a)
+        : bits(static_cast<uint64_t>(a)) {
+        if (a < 0) {
+            for (size_t i = 2; i < bits_type::LIMBS; i++) {
+                bits.limb[i] = UINT32_MAX;
+            }
+        }
+    }
+
+    explicit big_int(big_integer const& a)
+        : bits(big_integer(a.sign ? -a : a)) {
+        bool fits = bits.limb[bits_type::LIMBS - 1] >> 31 == 0 ||
+                    (a.sign && bits == (bits_type(1) << (Bits - 1)));
+        check(fits && static_cast<big_integer>(bits) == (a.sign ? -a : a));
+        if (a.sign) {
+            bits = -bits;
+        }
+    }
+
+    explicit operator big_integer() const {
+        big_integer res = static_cast<big_integer>(negative() ? -bits : bits);
+        return negative() ? -res : res;
+    }
+
+    constexpr bool negative() const {
+        return bits.limb[bits_type::LIMBS - 1] >> 31 != 0;
+    }
+
+    constexpr big_int& operator+=(big_int const& rhs) {
+        bool same = negative() == rhs.negative();
+        bits += rhs.bits;
+        check(!same || negative() == rhs.negative());
+        return *this;
+    }
+
+    constexpr big_int& operator-=(big_int const& rhs) {
+        bool differ = negative() != rhs.negative();
+        bool was = negative();
+        bits -= rhs.bits;
+        check(!differ || negative() == was);
+        return *this;
+    }
+
+    constexpr big_int& operator*=(big_int const& rhs) {
+        if (Mode == overflow::wrap) {
+            bits *= rhs.bits;
+            return *this;
+        }
+        bool neg = negative() != rhs.negative();
+        big_uint<Bits, overflow::check> a(magnitude()), b(rhs.magnitude());
+        bits = bits_type(a *= b);
+        bits_type limit = bits_type(1) << (Bits - 1);
+        check(bits < limit || (neg && bits == limit));
+        if (neg) {
+            bits = -bits;
+        }
+        return *this;
+    }
+
+    constexpr big_int& operator/=(big_int const& rhs) {
+        bool neg = negative() != rhs.negative();
+        bits_type q, r;
+        bits_type::divmod(magnitude(), rhs.magnitude(), q, r);
+        check(!(q.limb[bits_type::LIMBS - 1] >> 31 != 0 && !neg));
+        bits = neg ? -q : q;
+        return *this;
+    }
+
+    constexpr big_int& operator%=(big_int const& rhs) {
+        bool neg = negative();
+        bits_type q, r;
+        bits_type::divmod(magnitude(), rhs.magnitude(), q, r);
+        bits = neg ? -r : r;
+        return *this;
+    }
+
+    // In check mode the bits shifted out and the new sign bit must all be
+    // copies of the old sign bit.
+    constexpr big_int& operator<<=(unsigned rhs) {
+        if (Mode == overflow::check) {
+            bits_type same = negative() ? ~bits : bits;
+            check(rhs < Bits ? (same >> (Bits - 1 - rhs)) == bits_type() : bits == bits_type());
+        }
+        bits <<= rhs;
+        return *this;
+    }
+
+    // Arithmetic shift: rounds toward minus infinity like big_integer.
+    constexpr big_int& operator>>=(unsigned rhs) {
+        bool neg = negative();
+        bits >>= rhs;
+        if (neg) {
+            bits |= ~(~bits_type() >> rhs);
+        }
+        return *this;
+    }
+
+    constexpr big_int operator-() const {
+        check(!negative() || bits != (bits_type(1) << (Bits - 1)));
+        big_int res;
+        res.bits = -bits;
+        return res;
+    }
+
+    constexpr friend big_int operator+(big_int a, big_int const& b) {
+        return a += b;
+    }
+
+    constexpr friend big_int operator-(big_int a, big_int const& b) {
+        return a -= b;
+    }
+
+    constexpr friend big_int operator*(big_int a, big_int const& b) {
+        return a *= b;
+    }
+
+    constexpr friend big_int operator/(big_int a, big_int const& b) {
+        return a /= b;
+    }
+
+    constexpr friend big_int operator%(big_int a, big_int const& b) {
+        return a %= b;
+    }
+
+    constexpr friend big_int operator<<(big_int a, unsigned b) {
+        return a <<= b;
+    }
+
+    constexpr friend big_int operator>>(big_int a, unsigned b) {
+        return a >>= b;
+    }
+
+    constexpr friend bool operator==(big_int const& a, big_int const& b) {
+        return a.bits == b.bits;
+    }
+
+    constexpr friend bool operator!=(big_int const& a, big_int const& b) {
+        return a.bits != b.bits;
+    }
+
+    constexpr friend bool operator<(big_int const& a, big_int const& b) {
+        if (a.negative() != b.negative()) {
+            return a.negative();
+        }
+        return a.bits < b.bits;
+    }
+
+    constexpr friend bool operator>(big_int const& a, big_int const& b) {
+        return b < a;
+    }
+
+    constexpr friend bool operator<=(big_int const& a, big_int const& b) {
+        return !(b < a);
+    }
+
+    constexpr friend bool operator>=(big_int const& a, big_int const& b) {
+        return !(a < b);
+    }
+
+private:
+    constexpr bits_type magnitude() const {
+        return negative() ? -bits : bits;
+    }
+
+    constexpr static void check(bool ok) {
+        if (Mode == overflow::check && !ok) {
+            throw std::overflow_error("fixed-width integer overflow");
+        }
+    }
+};
+
+namespace fixed_width_detail {
+
+constexpr unsigned literal_base(char const* s, size_t n) {
+    if (n > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        return 16;
+    }
+    if (n > 2 && s[0] == '0' && (s[1] == 'b' || s[1] == 'B')) {
+        return 2;
+    }
+    return n > 1 && s[0] == '0' ? 8 : 10;
+}
+
+// Enough bits for any literal with this many digits, rounded up to whole limbs.
+template <char... Digits>
+constexpr size_t literal_bits() {
+    char const s[] = {Digits...};
+    size_t n = sizeof...(Digits);
+    unsigned base = literal_base(s, n);
+    if (base == 16 || base == 2) {
+        n -= 2;
+    }
+    size_t bits = base == 16 ? 4 * n : base == 8 ? 3 * n : base == 2 ? n : (n * 3322 + 999) / 1000;
+    bits = (bits + 31) / 32 * 32;
+    return bits < 64 ? 64 : bits;
+}
+
+template <size_t Bits, char... Digits>
+constexpr big_uint<Bits> parse_literal() {
+    char const s[] = {Digits...};
+    size_t n = sizeof...(Digits);
+    unsigned base = literal_base(s, n);
+    big_uint<Bits, overflow::check> res;
+    for (size_t i = base == 16 || base == 2 ? 2 : 0; i < n; i++) {
+        if (s[i] == '\'') {
+            continue;
+        }
+        unsigned digit = s[i] <= '9' ? s[i] - '0' : (s[i] | 0x20) - 'a' + 10;
+        res = res * base + digit;
+    }
+    return big_uint<Bits>(res);
+}
+
+}
+
+// 123456789012345678901234567890_bi is parsed by the compiler: the result is a
+// big_uint just wide enough for the digits and usable in constant expressions,
+// so constexpr tables of such constants are placed in read-only data and cost
+// nothing at startup. Decimal, 0x, 0b and octal spellings are accepted.
+template <char... Digits>
+constexpr big_uint<fixed_width_detail::literal_bits<Digits...>()> operator"" _bi() {
+    return fixed_width_detail::parse_literal<fixed_width_detail::literal_bits<Digits...>(), Digits...>();
+}
+
+#endif //BIGINT_FIXED_WIDTH_H
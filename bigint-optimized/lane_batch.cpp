@@ -0,0 +1,29 @@
+#include "lane_batch.h"
+
+namespace {
+
+// Versioned like the kernels, so the loader makes the same choice for it.
+// Calls only go through the dispatcher where every version is visible.
+#ifdef BIGINT_LANE_CLONES
+__attribute__((target("avx512f"))) char const* selected_target() {
+    return "avx512f";
+}
+
+__attribute__((target("avx2"))) char const* selected_target() {
+    return "avx2";
+}
+
+__attribute__((target("default"))) char const* selected_target() {
+    return "default";
+}
+#else
+char const* selected_target() {
+    return "default";
+}
+#endif
+
+}
+
+char const* lane_batch_target() {
+    return selected_target();
+}
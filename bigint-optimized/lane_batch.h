@@ -0,0 +1,143 @@
+#ifndef BIGINT_LANE_BATCH_H
+#define BIGINT_LANE_BATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "fixed_width.h"
+
+// A batch of Lanes independent big_uint<Bits>, stored limb-major: limb[i]
+// holds limb i of every lane side by side. Each operation walks the limbs in
+// order with one carry per lane, and the inner loop over the lanes has no
+// dependence between iterations, so the compiler turns it into vector code
+// (one lane per vector element). With GCC on x86-64 Linux each kernel is
+// also compiled for AVX2 and AVX-512, and the dynamic loader binds the
+// widest version the processor supports, so the default build gets full-width
+// vectors without -march flags. Elsewhere the kernels are built for the
+// target as is. Arithmetic wraps modulo 2^Bits, like big_uint in wrap mode.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define BIGINT_LANE_CLONES 1
+#define BIGINT_LANE_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define BIGINT_LANE_KERNEL
+#endif
+
+// The instruction set the kernels run with here: "avx512f", "avx2" or
+// "default".
+char const* lane_batch_target();
+
+template <size_t Bits, size_t Lanes = 8>
+struct big_uint_lanes {
+    static_assert(Bits >= 64 && Bits % 32 == 0, "width must be a multiple of 32 bits, at least 64");
+    static_assert(Lanes > 0, "a batch needs at least one lane");
+    static const size_t LIMBS = Bits / 32;
+    static const size_t LANES = Lanes;
+
+    uint32_t limb[LIMBS][Lanes];
+
+    big_uint_lanes()
+        : limb() {}
+
+    template <overflow Mode>
+    void set(size_t lane, big_uint<Bits, Mode> const& a) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            limb[i][lane] = a.limb[i];
+        }
+    }
+
+    big_uint<Bits> get(size_t lane) const {
+        big_uint<Bits> res;
+        for (size_t i = 0; i < LIMBS; i++) {
+            res.limb[i] = limb[i][lane];
+        }
+        return res;
+    }
+
+    BIGINT_LANE_KERNEL big_uint_lanes& operator+=(big_uint_lanes const& rhs) {
+        uint32_t carry[Lanes] = {};
+        for (size_t i = 0; i < LIMBS; i++) {
+            for (size_t l = 0; l < Lanes; l++) {
+                uint64_t s = static_cast<uint64_t>(limb[i][l]) + rhs.limb[i][l] + carry[l];
+                limb[i][l] = static_cast<uint32_t>(s);
+                carry[l] = static_cast<uint32_t>(s >> 32);
+            }
+        }
+        return *this;
+    }
+
+    BIGINT_LANE_KERNEL big_uint_lanes& operator-=(big_uint_lanes const& rhs) {
+        uint32_t borrow[Lanes] = {};
+        for (size_t i = 0; i < LIMBS; i++) {
+            for (size_t l = 0; l < Lanes; l++) {
+                uint64_t c = static_cast<uint64_t>(limb[i][l]) - rhs.limb[i][l] - borrow[l];
+                limb[i][l] = static_cast<uint32_t>(c);
+                borrow[l] = static_cast<uint32_t>(c >> 32) & 1U;
+            }
+        }
+        return *this;
+    }
+
+    // Column by column, keeping only the product limbs below 2^Bits. The low
+    // and high halves of the partial products of a column go into separate
+    // 64-bit sums, so nothing carries until the column is complete.
+    BIGINT_LANE_KERNEL big_uint_lanes& operator*=(big_uint_lanes const& rhs) {
+        uint32_t res[LIMBS][Lanes];
+        uint64_t carry[Lanes] = {};
+        for (size_t k = 0; k < LIMBS; k++) {
+            uint64_t low[Lanes], high[Lanes];
+            for (size_t l = 0; l < Lanes; l++) {
+                low[l] = carry[l] & UINT32_MAX;
+                high[l] = carry[l] >> 32;
+            }
+            for (size_t i = 0; i <= k; i++) {
+                for (size_t l = 0; l < Lanes; l++) {
+                    uint64_t t = static_cast<uint64_t>(limb[i][l]) * rhs.limb[k - i][l];
+                    low[l] += t & UINT32_MAX;
+                    high[l] += t >> 32;
+                }
+            }
+            for (size_t l = 0; l < Lanes; l++) {
+                res[k][l] = static_cast<uint32_t>(low[l]);
+                carry[l] = (low[l] >> 32) + high[l];
+            }
+        }
+        for (size_t i = 0; i < LIMBS; i++) {
+            for (size_t l = 0; l < Lanes; l++) {
+                limb[i][l] = res[i][l];
+            }
+        }
+        return *this;
+    }
+
+    friend big_uint_lanes operator+(big_uint_lanes a, big_uint_lanes const& b) {
+        return a += b;
+    }
+
+    friend big_uint_lanes operator-(big_uint_lanes a, big_uint_lanes const& b) {
+        return a -= b;
+    }
+
+    friend big_uint_lanes operator*(big_uint_lanes a, big_uint_lanes const& b) {
+        return a *= b;
+    }
+
+    // Per lane, -1, 0 or 1 as a is less than, equal to or greater than b. The
+    // limbs are scanned from the low end, each nonzero difference overriding
+    // those below it, so there is no early exit to diverge on.
+    BIGINT_LANE_KERNEL friend std::array<int, Lanes> compare(big_uint_lanes const& a, big_uint_lanes const& b) {
+        int64_t diff[Lanes] = {};
+        for (size_t i = 0; i < LIMBS; i++) {
+            for (size_t l = 0; l < Lanes; l++) {
+                int64_t d = static_cast<int64_t>(a.limb[i][l]) - b.limb[i][l];
+                diff[l] = d != 0 ? d : diff[l];
+            }
+        }
+        std::array<int, Lanes> out;
+        for (size_t l = 0; l < Lanes; l++) {
+            out[l] = (diff[l] > 0) - (diff[l] < 0);
+        }
+        return out;
+    }
+};
+
+#endif //BIGINT_LANE_BATCH_H
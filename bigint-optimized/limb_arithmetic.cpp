@@ -0,0 +1,443 @@
+#include "limb_arithmetic.h"
+
+#include <algorithm>
+#include <utility>
+#include "parallel.h"
+
+static const uint32_t SHIFT = 32;
+static const size_t KARATSUBA_THRESHOLD = 32;
+static const size_t KARATSUBA_SQR_THRESHOLD = 48;
+static const size_t BDIV_DC_THRESHOLD = 2 * KARATSUBA_THRESHOLD;
+// Below this many limbs in the shorter operand a product is not worth
+// splitting across threads.
+static const size_t PARALLEL_MUL_THRESHOLD = 1024;
+
+int cmp_n(uint32_t const* a, uint32_t const* b, size_t n) {
+    for (size_t i = n; i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+uint32_t add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(a[i]) + b[i];
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= SHIFT;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t c = static_cast<uint64_t>(a[i]) - b[i] - borrow;
+        r[i] = static_cast<uint32_t>(c);
+        borrow = static_cast<uint32_t>(c >> SHIFT) & 1U;
+    }
+    return borrow;
+}
+
+uint32_t mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(a[i]) * b;
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= SHIFT;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        carry += static_cast<uint64_t>(a[i]) * b + r[i];
+        r[i] = static_cast<uint32_t>(carry);
+        carry >>= SHIFT;
+    }
+    return static_cast<uint32_t>(carry);
+}
+
+uint32_t submul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b) {
+    uint32_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t p = static_cast<uint64_t>(a[i]) * b + borrow;
+        uint32_t low = static_cast<uint32_t>(p);
+        borrow = static_cast<uint32_t>(p >> SHIFT) + (r[i] < low);
+        r[i] -= low;
+    }
+    return borrow;
+}
+
+uint32_t add(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    uint32_t carry = add_n(r, a, b, bn);
+    for (size_t i = bn; i < an; i++) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
+
+uint32_t sub(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    uint32_t borrow = sub_n(r, a, b, bn);
+    for (size_t i = bn; i < an; i++) {
+        uint32_t x = a[i];
+        r[i] = x - borrow;
+        borrow = x < borrow;
+    }
+    return borrow;
+}
+
+void mul_basecase(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    std::fill(r, r + an, 0);
+    for (size_t i = 0; i < bn; i++) {
+        r[an + i] = addmul_1(r + i, a, an, b[i]);
+    }
+}
+
+// Every cross product a[i] * a[j], i < j, is computed once and doubled, then
+// the squares a[i]^2 are added on the diagonal: about half of mul_basecase.
+void sqr_basecase(uint32_t* r, uint32_t const* a, size_t n) {
+    std::fill(r, r + n + 1, 0);
+    for (size_t i = 0; i < n; i++) {
+        r[i + n] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+    lshift(r, r, 2 * n, 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t sq = static_cast<uint64_t>(a[i]) * a[i];
+        uint64_t low = static_cast<uint64_t>(r[2 * i]) + static_cast<uint32_t>(sq) + carry;
+        r[2 * i] = static_cast<uint32_t>(low);
+        uint64_t high = static_cast<uint64_t>(r[2 * i + 1]) + (sq >> SHIFT) + (low >> SHIFT);
+        r[2 * i + 1] = static_cast<uint32_t>(high);
+        carry = high >> SHIFT;
+    }
+}
+
+namespace {
+
+// a * b for an >= 2 * bn: b times each bn-limb slice of a.
+void mul_unbalanced(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    std::vector<uint32_t> t(2 * bn);
+    for (size_t off = 0; off < an; off += bn) {
+        size_t len = std::min(bn, an - off);
+        mul_n(t.data(), b, bn, a + off, len);
+        add(r + off, r + off, an + bn - off, t.data(), bn + len);
+    }
+}
+
+// With a = a1 * B^h + a0 and b = b1 * B^h + b0, the middle coefficient
+// a0 * b1 + a1 * b0 is (a0 + a1)(b0 + b1) - a0 * b0 - a1 * b1: three half-size
+// products instead of four. They are independent, so with parallel set they
+// run as tasks and recurse in parallel themselves.
+void karatsuba(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn, bool parallel) {
+    check_cancelled();
+    size_t h = an / 2;
+    std::vector<uint32_t> sa(an - h + 1), sb(std::max(h, bn - h) + 1);
+    sa[an - h] = add(sa.data(), a + h, an - h, a, h);
+    if (bn - h >= h) {
+        sb[bn - h] = add(sb.data(), b + h, bn - h, b, h);
+    } else {
+        sb[h] = add(sb.data(), b, h, b + h, bn - h);
+    }
+    size_t la = sa.size() - (sa.back() == 0), lb = sb.size() - (sb.back() == 0);
+    std::vector<uint32_t> mid(la + lb);
+    if (parallel) {
+        task_group tasks;
+        tasks.run([=] { mul_n_parallel(r, a, h, b, h); });
+        tasks.run([=] { mul_n_parallel(r + 2 * h, a + h, an - h, b + h, bn - h); });
+        mul_n_parallel(mid.data(), sa.data(), la, sb.data(), lb);
+        tasks.wait();
+    } else {
+        mul_n(r, a, h, b, h);
+        mul_n(r + 2 * h, a + h, an - h, b + h, bn - h);
+        mul_n(mid.data(), sa.data(), la, sb.data(), lb);
+    }
+    sub(mid.data(), mid.data(), mid.size(), r, 2 * h);
+    sub(mid.data(), mid.data(), mid.size(), r + 2 * h, an + bn - 2 * h);
+    add(r + h, r + h, an + bn - h, mid.data(), std::min(mid.size(), an + bn - h));
+}
+
+void karatsuba_sqr(uint32_t* r, uint32_t const* a, size_t n, bool parallel) {
+    check_cancelled();
+    size_t h = n / 2;
+    std::vector<uint32_t> s(n - h + 1);
+    s[n - h] = add(s.data(), a + h, n - h, a, h);
+    size_t ls = s.size() - (s.back() == 0);
+    std::vector<uint32_t> mid(2 * ls);
+    if (parallel) {
+        task_group tasks;
+        tasks.run([=] { sqr_n_parallel(r, a, h); });
+        tasks.run([=] { sqr_n_parallel(r + 2 * h, a + h, n - h); });
+        sqr_n_parallel(mid.data(), s.data(), ls);
+        tasks.wait();
+    } else {
+        sqr_n(r, a, h);
+        sqr_n(r + 2 * h, a + h, n - h);
+        sqr_n(mid.data(), s.data(), ls);
+    }
+    sub(mid.data(), mid.data(), mid.size(), r, 2 * h);
+    sub(mid.data(), mid.data(), mid.size(), r + 2 * h, 2 * (n - h));
+    add(r + h, r + h, 2 * n - h, mid.data(), std::min(mid.size(), 2 * n - h));
+}
+
+// The slices of mul_unbalanced multiplied concurrently into separate
+// buffers, then added in order.
+void mul_unbalanced_parallel(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    size_t slices = (an + bn - 1) / bn;
+    std::vector<std::vector<uint32_t>> t(slices);
+    parallel_for(slices, 0, [&](size_t i) {
+        size_t off = i * bn, len = std::min(bn, an - off);
+        t[i].resize(bn + len);
+        mul_n_parallel(t[i].data(), b, bn, a + off, len);
+    });
+    std::fill(r, r + an + bn, 0);
+    for (size_t i = 0; i < slices; i++) {
+        size_t off = i * bn;
+        add(r + off, r + off, an + bn - off, t[i].data(), t[i].size());
+    }
+}
+
+}
+
+void mul_n(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < KARATSUBA_THRESHOLD) {
+        mul_basecase(r, a, an, b, bn);
+    } else if (an >= 2 * bn) {
+        mul_unbalanced(r, a, an, b, bn);
+    } else {
+        karatsuba(r, a, an, b, bn, false);
+    }
+}
+
+void sqr_n(uint32_t* r, uint32_t const* a, size_t n) {
+    if (n < KARATSUBA_SQR_THRESHOLD) {
+        sqr_basecase(r, a, n);
+    } else {
+        karatsuba_sqr(r, a, n, false);
+    }
+}
+
+void mul_n_parallel(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn < PARALLEL_MUL_THRESHOLD || shared_pool().threads() == 1) {
+        mul_n(r, a, an, b, bn);
+    } else if (an >= 2 * bn) {
+        mul_unbalanced_parallel(r, a, an, b, bn);
+    } else {
+        karatsuba(r, a, an, b, bn, true);
+    }
+}
+
+void sqr_n_parallel(uint32_t* r, uint32_t const* a, size_t n) {
+    if (n < PARALLEL_MUL_THRESHOLD || shared_pool().threads() == 1) {
+        sqr_n(r, a, n);
+    } else {
+        karatsuba_sqr(r, a, n, true);
+    }
+}
+
+uint32_t lshift(uint32_t* r, uint32_t const* a, size_t n, uint32_t cnt) {
+    if (n == 0) {
+        return 0;
+    }
+    if (cnt == 0) {
+        std::copy_backward(a, a + n, r + n);
+        return 0;
+    }
+    uint32_t out = a[n - 1] >> (SHIFT - cnt);
+    for (size_t i = n - 1; i > 0; i--) {
+        r[i] = (a[i] << cnt) | (a[i - 1] >> (SHIFT - cnt));
+    }
+    r[0] = a[0] << cnt;
+    return out;
+}
+
+uint32_t rshift(uint32_t* r, uint32_t const* a, size_t n, uint32_t cnt) {
+    if (n == 0) {
+        return 0;
+    }
+    if (cnt == 0) {
+        std::copy(a, a + n, r);
+        return 0;
+    }
+    uint32_t out = a[0] << (SHIFT - cnt);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i] = (a[i] >> cnt) | (a[i + 1] << (SHIFT - cnt));
+    }
+    r[n - 1] = a[n - 1] >> cnt;
+    return out;
+}
+
+uint32_t leading_zeros(uint32_t x) {
+    return x == 0 ? SHIFT : static_cast<uint32_t>(__builtin_clz(x));
+}
+
+uint32_t binvert_limb(uint32_t a) {
+    uint32_t inv = a;
+    for (int i = 0; i < 4; i++) {
+        inv *= 2 - a * inv;
+    }
+    return inv;
+}
+
+void bdiv_q(uint32_t* q, uint32_t* u, size_t qn, uint32_t const* v, size_t vn) {
+    vn = std::min(vn, qn);
+    if (qn >= BDIV_DC_THRESHOLD) {
+        size_t lo = qn / 2;
+        bdiv_q(q, u, lo, v, vn);
+        std::vector<uint32_t> p(lo + vn);
+        mul_n(p.data(), q, lo, v, vn);
+        size_t len = std::min(p.size(), qn) - lo;
+        sub(u + lo, u + lo, qn - lo, p.data() + lo, len);
+        bdiv_q(q + lo, u + lo, qn - lo, v, vn);
+        return;
+    }
+    uint32_t inv = binvert_limb(v[0]);
+    for (size_t i = 0; i < qn; i++) {
+        uint32_t cur = u[i] * inv;
+        q[i] = cur;
+        size_t len = std::min(vn, qn - i);
+        uint32_t borrow = submul_1(u + i, v, len, cur);
+        for (size_t j = i + len; borrow != 0 && j < qn; j++) {
+            uint32_t x = u[j];
+            u[j] = x - borrow;
+            borrow = x < borrow;
+        }
+    }
+}
+
+uint32_t invert_limb(uint32_t d) {
+    return static_cast<uint32_t>(UINT64_MAX / d - (1ULL << SHIFT));
+}
+
+uint32_t invert_pi1(uint32_t d1, uint32_t d0) {
+    uint32_t v = invert_limb(d1);
+    uint32_t p = d1 * v + d0;
+    if (p < d0) {
+        v--;
+        if (p >= d1) {
+            v--;
+            p -= d1;
+        }
+        p -= d1;
+    }
+    uint64_t t = static_cast<uint64_t>(d0) * v;
+    uint32_t t1 = static_cast<uint32_t>(t >> SHIFT);
+    uint32_t t0 = static_cast<uint32_t>(t);
+    p += t1;
+    if (p < t1) {
+        v--;
+        if (p > d1 || (p == d1 && t0 >= d0)) {
+            v--;
+        }
+    }
+    return v;
+}
+
+uint32_t div_2by1(uint32_t& r, uint32_t u1, uint32_t u0, uint32_t d, uint32_t inv) {
+    uint64_t q = static_cast<uint64_t>(inv) * u1 + ((static_cast<uint64_t>(u1) << SHIFT) | u0);
+    uint32_t q1 = static_cast<uint32_t>(q >> SHIFT) + 1;
+    uint32_t q0 = static_cast<uint32_t>(q);
+    uint32_t rem = u0 - q1 * d;
+    if (rem > q0) {
+        q1--;
+        rem += d;
+    }
+    if (rem >= d) {
+        q1++;
+        rem -= d;
+    }
+    r = rem;
+    return q1;
+}
+
+uint32_t div_3by2(uint32_t u2, uint32_t u1, uint32_t u0,
+                  uint32_t d1, uint32_t d0, uint32_t inv) {
+    uint64_t d = (static_cast<uint64_t>(d1) << SHIFT) | d0;
+    uint64_t q = static_cast<uint64_t>(inv) * u2 + ((static_cast<uint64_t>(u2) << SHIFT) | u1);
+    uint32_t q1 = static_cast<uint32_t>(q >> SHIFT);
+    uint32_t q0 = static_cast<uint32_t>(q);
+    uint32_t r1 = u1 - d1 * q1;
+    uint64_t r = ((static_cast<uint64_t>(r1) << SHIFT) | u0) - d;
+    r -= static_cast<uint64_t>(d0) * q1;
+    q1++;
+    if (static_cast<uint32_t>(r >> SHIFT) >= q0) {
+        q1--;
+        r += d;
+    }
+    if (r >= d) {
+        q1++;
+    }
+    return q1;
+}
+
+uint32_t divrem_1(uint32_t* q, uint32_t const* a, size_t n, uint32_t d) {
+    uint32_t s = leading_zeros(d);
+    uint32_t dn = d << s, inv = invert_limb(dn);
+    uint32_t r = s != 0 ? a[n - 1] >> (SHIFT - s) : 0;
+    for (size_t i = n; i-- > 0;) {
+        uint32_t u = a[i] << s;
+        if (s != 0 && i > 0) {
+            u |= a[i - 1] >> (SHIFT - s);
+        }
+        q[i] = div_2by1(r, r, u, dn, inv);
+    }
+    return r >> s;
+}
+
+uint32_t mod_1(uint32_t const* a, size_t n, uint32_t d) {
+    uint32_t s = leading_zeros(d);
+    uint32_t dn = d << s, inv = invert_limb(dn);
+    uint32_t r = s != 0 ? a[n - 1] >> (SHIFT - s) : 0;
+    for (size_t i = n; i-- > 0;) {
+        uint32_t u = a[i] << s;
+        if (s != 0 && i > 0) {
+            u |= a[i - 1] >> (SHIFT - s);
+        }
+        div_2by1(r, r, u, dn, inv);
+    }
+    return r >> s;
+}
+
+uint64_t divrem_2(uint32_t* q, uint32_t const* a, size_t n, uint64_t d) {
+    uint32_t s = leading_zeros(static_cast<uint32_t>(d >> SHIFT));
+    uint64_t dn = d << s;
+    uint32_t d1 = static_cast<uint32_t>(dn >> SHIFT), d0 = static_cast<uint32_t>(dn);
+    uint32_t inv = invert_pi1(d1, d0);
+    uint64_t r = s != 0 ? a[n - 1] >> (SHIFT - s) : 0;
+    for (size_t i = n; i-- > 0;) {
+        uint32_t u = a[i] << s;
+        if (s != 0 && i > 0) {
+            u |= a[i - 1] >> (SHIFT - s);
+        }
+        uint32_t cur = div_3by2(static_cast<uint32_t>(r >> SHIFT), static_cast<uint32_t>(r), u, d1, d0, inv);
+        r = ((r << SHIFT) | u) - cur * dn;
+        if (q) {
+            q[i] = cur;
+        }
+    }
+    return r >> s;
+}
+
+big_integer from_limbs(std::vector<uint32_t> limbs, bool sign) {
+    if (limbs.empty()) {
+        limbs.push_back(0);
+    }
+    big_integer res;
+    res.num = shared_vector_small_object(std::move(limbs));
+    res.sign = sign;
+    res.normalize();
+    return res;
+}
@@ -0,0 +1,75 @@
+#ifndef BIGINT_LIMB_ARITHMETIC_H
+#define BIGINT_LIMB_ARITHMETIC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "big_integer.h"
+
+// Kernels over little-endian arrays of 32-bit limbs. They know nothing about
+// signs or normalization; callers size the output and handle both.
+
+int cmp_n(uint32_t const* a, uint32_t const* b, size_t n);
+
+uint32_t add_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+uint32_t sub_n(uint32_t* r, uint32_t const* a, uint32_t const* b, size_t n);
+
+uint32_t mul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+uint32_t addmul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+uint32_t submul_1(uint32_t* r, uint32_t const* a, size_t n, uint32_t b);
+
+// Adds or subtracts a shorter operand, an >= bn, propagating through the rest of a.
+uint32_t add(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+uint32_t sub(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+
+// r must not overlap the inputs and has room for an + bn (2n) limbs.
+void mul_basecase(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+void sqr_basecase(uint32_t* r, uint32_t const* a, size_t n);
+
+// Pick schoolbook or Karatsuba by operand size; same contract as above.
+void mul_n(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+void sqr_n(uint32_t* r, uint32_t const* a, size_t n);
+
+// The same on the shared pool: Karatsuba's three subproducts, or the slices
+// of an unbalanced product, are computed concurrently down to about a
+// thousand limbs. The limbs are identical to the serial result, whatever the
+// number of threads.
+void mul_n_parallel(uint32_t* r, uint32_t const* a, size_t an, uint32_t const* b, size_t bn);
+void sqr_n_parallel(uint32_t* r, uint32_t const* a, size_t n);
+
+// Shifts by 0 <= cnt < 32 bits, returning the bits shifted out.
+uint32_t lshift(uint32_t* r, uint32_t const* a, size_t n, uint32_t cnt);
+uint32_t rshift(uint32_t* r, uint32_t const* a, size_t n, uint32_t cnt);
+
+uint32_t leading_zeros(uint32_t x);
+
+// Inverse of an odd limb modulo 2^32.
+uint32_t binvert_limb(uint32_t a);
+
+// Exact quotient of u (qn limbs, clobbered) by an odd v, computed from the
+// low end: each quotient limb is u[i] * v[0]^-1 mod 2^32, with no estimate
+// to correct. Only the low qn limbs of u take part. Long quotients are split
+// in halves joined by one mul_n, so large divisions run at Karatsuba speed.
+void bdiv_q(uint32_t* q, uint32_t* u, size_t qn, uint32_t const* v, size_t vn);
+
+// Reciprocals of a normalized divisor (top bit set), see Moller and Granlund,
+// "Improved division by invariant integers".
+uint32_t invert_limb(uint32_t d);
+uint32_t invert_pi1(uint32_t d1, uint32_t d0);
+
+uint32_t div_2by1(uint32_t& r, uint32_t u1, uint32_t u0, uint32_t d, uint32_t inv);
+uint32_t div_3by2(uint32_t u2, uint32_t u1, uint32_t u0,
+                  uint32_t d1, uint32_t d0, uint32_t inv);
+
+// Division by a nonzero limb with the 2/1 reciprocal, returning the
+// remainder; q may be a. mod_1 only computes the remainder.
+uint32_t divrem_1(uint32_t* q, uint32_t const* a, size_t n, uint32_t d);
+uint32_t mod_1(uint32_t const* a, size_t n, uint32_t d);
+
+// The same for a two-limb divisor, 2^32 <= d, with the 3/2 reciprocal; q may
+// be null when only the remainder is wanted.
+uint64_t divrem_2(uint32_t* q, uint32_t const* a, size_t n, uint64_t d);
+
+big_integer from_limbs(std::vector<uint32_t> limbs, bool sign);
+
+#endif //BIGINT_LIMB_ARITHMETIC_H
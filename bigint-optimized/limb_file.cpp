@@ -0,0 +1,167 @@
+#include "limb_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "byte_conversion.h"
+#include "limb_arithmetic.h"
+#include "radix_conversion.h"
+
+namespace {
+
+char const MAGIC[8] = {'B', 'I', 'G', 'I', 'N', 'T', '\r', '\n'};
+uint32_t const NEGATIVE = 1;
+
+bool const HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+void put_le(unsigned char* p, uint64_t x, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        p[i] = static_cast<unsigned char>(x >> (8 * i));
+    }
+}
+
+uint64_t get_le(unsigned char const* p, size_t size) {
+    uint64_t x = 0;
+    for (size_t i = 0; i < size; i++) {
+        x |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    return x;
+}
+
+std::system_error io_error(std::string const& path) {
+    return std::system_error(errno, std::generic_category(), path);
+}
+
+// Closes the descriptor on every path out of save and load.
+class file {
+public:
+    explicit file(int fd)
+        : fd(fd) {}
+
+    ~file() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    file(file const&) = delete;
+    file& operator=(file const&) = delete;
+
+    int fd;
+};
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Maps the whole of path read-only; the mapping goes away with the pointer.
+std::shared_ptr<void const> map_file(std::string const& path, size_t& size) {
+    file f(::open(path.c_str(), O_RDONLY));
+    struct stat st;
+    if (f.fd < 0 || ::fstat(f.fd, &st) != 0) {
+        throw io_error(path);
+    }
+    size = st.st_size;
+    if (size == 0) {
+        return std::shared_ptr<void const>(static_cast<void const*>(""), [](void const*) {});
+    }
+    void* map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, f.fd, 0);
+    if (map == MAP_FAILED) {
+        throw io_error(path);
+    }
+    return std::shared_ptr<void const>(map, [size](void const* p) {
+        ::munmap(const_cast<void*>(p), size);
+    });
+}
+
+void write_all(int fd, void const* data, size_t size, std::string const& path) {
+    char const* p = static_cast<char const*>(data);
+    while (size != 0) {
+        ssize_t written = ::write(fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw io_error(path);
+        }
+        p += written;
+        size -= written;
+    }
+}
+
+}
+
+void save_limb_file(std::string const& path, big_integer const& a) {
+    size_t n = a.num[a.num.size() - 1] == 0 ? 0 : a.num.size();
+    unsigned char header[LIMB_FILE_HEADER_SIZE] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    put_le(header + 8, LIMB_FILE_VERSION, 4);
+    put_le(header + 12, a.sign ? NEGATIVE : 0, 4);
+    put_le(header + 16, n, 8);
+    file f(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if (f.fd < 0) {
+        throw io_error(path);
+    }
+    write_all(f.fd, header, sizeof(header), path);
+    if (HOST_LITTLE_ENDIAN) {
+        write_all(f.fd, a.num.data(), n * 4, path);
+    } else {
+        std::vector<unsigned char> limbs(n * 4);
+        export_bytes(limbs.data(), a, 4, word_order::least_significant_first, byte_order::little);
+        write_all(f.fd, limbs.data(), limbs.size(), path);
+    }
+}
+
+big_integer load_limb_file(std::string const& path, bool view) {
+    size_t size;
+    std::shared_ptr<void const> mapping = map_file(path, size);
+    unsigned char const* header = static_cast<unsigned char const*>(mapping.get());
+    if (size < LIMB_FILE_HEADER_SIZE) {
+        throw std::invalid_argument("invalid limb file");
+    }
+    uint64_t n = get_le(header + 16, 8);
+    uint64_t flags = get_le(header + 12, 4);
+    if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || get_le(header + 8, 4) != LIMB_FILE_VERSION
+        || (flags & ~uint64_t(NEGATIVE)) != 0 || get_le(header + 24, 8) != 0
+        || (size - LIMB_FILE_HEADER_SIZE) / 4 != n || (size - LIMB_FILE_HEADER_SIZE) % 4 != 0) {
+        throw std::invalid_argument("invalid limb file");
+    }
+    bool negative = (flags & NEGATIVE) != 0;
+    unsigned char const* limbs = header + LIMB_FILE_HEADER_SIZE;
+    if (!HOST_LITTLE_ENDIAN) {
+        big_integer res = import_bytes(limbs, n, 4, word_order::least_significant_first, byte_order::little);
+        res.sign = negative && res != 0;
+        return res;
+    }
+    if (!view) {
+        std::vector<uint32_t> copy(n);
+        std::memcpy(copy.data(), limbs, 4 * n);
+        return from_limbs(std::move(copy), negative);
+    }
+    return big_integer(reinterpret_cast<uint32_t const*>(limbs), n, negative, mapping);
+}
+
+big_integer load_decimal_file(std::string const& path, unsigned threads) {
+    size_t size;
+    std::shared_ptr<void const> mapping = map_file(path, size);
+    if (size != 0) {
+        ::madvise(const_cast<void*>(mapping.get()), size, MADV_WILLNEED);
+    }
+    char const* first = static_cast<char const*>(mapping.get());
+    char const* last = first + size;
+    first = std::find_if_not(first, last, is_space);
+    big_integer res;
+    from_chars_result parsed = parallel_from_chars(first, last, res, 10, threads);
+    if (parsed.ec != std::errc() || std::find_if_not(parsed.ptr, last, is_space) != last) {
+        throw std::invalid_argument("invalid number");
+    }
+    return res;
+}
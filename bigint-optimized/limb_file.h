@@ -0,0 +1,47 @@
+#ifndef BIGINT_LIMB_FILE_H
+#define BIGINT_LIMB_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "big_integer.h"
+
+// A binary file holding one big_integer: a 32-byte header followed by the
+// limbs, least significant first. All fields are little-endian.
+//
+//   offset  size  field
+//        0     8  magic "BIGINT\r\n"
+//        8     4  version, LIMB_FILE_VERSION
+//       12     4  flags, bit 0 set for negative values, the others zero
+//       16     8  number of limbs n
+//       24     8  reserved, zero
+//       32    4n  limbs
+//
+// The header keeps the limbs aligned, so a mapping of the file can be used
+// as the value's storage directly. Loading rejects any other flag and a
+// nonzero reserved field, leaving both free for later versions.
+uint32_t const LIMB_FILE_VERSION = 1;
+size_t const LIMB_FILE_HEADER_SIZE = 32;
+
+// Writes a to path, replacing the file. Throws std::system_error on I/O
+// failure.
+void save_limb_file(std::string const& path, big_integer const& a);
+
+// Maps path read-only and returns a view of the limbs in it: nothing is
+// read until it is used and nothing is copied until it is modified. The
+// mapping lives as long as the value or a copy of it references it, and the
+// file must not be truncated or rewritten meanwhile: reading limbs that are
+// gone raises SIGBUS, and rewritten ones change the value. With view false
+// the limbs are copied out before the mapping is released, for files the
+// caller cannot keep unchanged. Throws std::system_error if the file cannot
+// be mapped and std::invalid_argument if it is not a limb file of a
+// supported version.
+big_integer load_limb_file(std::string const& path, bool view = true);
+
+// Reads a file holding one number in decimal, optionally surrounded by
+// whitespace, with parallel_from_chars on the given number of threads
+// straight from a mapping of it. Throws std::system_error if the file
+// cannot be mapped and std::invalid_argument if it holds anything else.
+big_integer load_decimal_file(std::string const& path, unsigned threads = 0);
+
+#endif //BIGINT_LIMB_FILE_H
@@ -0,0 +1,923 @@
+#include "number_theory.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "big_divisor.h"
+#include "limb_arithmetic.h"
+#include "parallel.h"
+
+static const uint32_t SHIFT = 32;
+// binomial multiplies out n - k + 1 .. n and divides by k! rather than
+// sieving up to n while k * k / BINOMIAL_SIEVE_RATIO < n.
+static const uint64_t BINOMIAL_SIEVE_RATIO = 16;
+// Operands with at least HGCD_THRESHOLD limbs go through half-GCD rounds
+// before the Lehmer steps; within a round, numbers of at most
+// HGCD_BASE_THRESHOLD limbs are no longer split.
+static const size_t HGCD_THRESHOLD = 1000;
+static const size_t HGCD_BASE_THRESHOLD = 64;
+
+namespace {
+
+size_t bit_length(big_integer const& a) {
+    size_t n = a.num.size();
+    return SHIFT * n - leading_zeros(a.num[n - 1]);
+}
+
+bool test_bit(big_integer const& a, size_t i) {
+    return (a.num[i / SHIFT] >> (i % SHIFT)) & 1U;
+}
+
+typedef std::vector<uint32_t> limbs;
+
+limbs magnitude(big_integer const& a) {
+    return limbs(a.num.data(), a.num.data() + a.num.size());
+}
+
+void trim(limbs& a) {
+    while (a.size() > 1 && a.back() == 0) {
+        a.pop_back();
+    }
+}
+
+bool less(limbs const& a, limbs const& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size();
+    }
+    return cmp_n(a.data(), b.data(), a.size()) < 0;
+}
+
+uint64_t limb_at(limbs const& a, size_t i) {
+    return i < a.size() ? a[i] : 0;
+}
+
+// Bits [from, from + 64) of a.
+uint64_t bits_at(limbs const& a, size_t from) {
+    size_t i = from / SHIFT;
+    uint32_t off = from % SHIFT;
+    uint64_t lo = limb_at(a, i) | (limb_at(a, i + 1) << SHIFT);
+    uint64_t hi = limb_at(a, i + 2);
+    return off == 0 ? lo : (lo >> off) | (hi << (2 * SHIFT - off));
+}
+
+// p * x - q * y for a combination known to be non-negative.
+limbs mul_sub(limbs const& x, uint32_t p, limbs const& y, uint32_t q) {
+    limbs r(std::max(x.size(), y.size()) + 1, 0);
+    r[x.size()] = mul_1(r.data(), x.data(), x.size(), p);
+    uint32_t borrow = submul_1(r.data(), y.data(), y.size(), q);
+    for (size_t i = y.size(); borrow != 0; i++) {
+        uint32_t old = r[i];
+        r[i] -= borrow;
+        borrow = old < borrow;
+    }
+    trim(r);
+    return r;
+}
+
+// p * x + q * y where p and q never share a sign.
+limbs combine(limbs const& x, int64_t p, limbs const& y, int64_t q) {
+    if (p >= 0 && q <= 0) {
+        return mul_sub(x, static_cast<uint32_t>(p), y, static_cast<uint32_t>(-q));
+    }
+    return mul_sub(y, static_cast<uint32_t>(q), x, static_cast<uint32_t>(-p));
+}
+
+// p * x + q * y.
+limbs mul_add(limbs const& x, uint32_t p, limbs const& y, uint32_t q) {
+    limbs r(std::max(x.size(), y.size()) + 2, 0);
+    r[x.size()] = mul_1(r.data(), x.data(), x.size(), p);
+    uint32_t carry = addmul_1(r.data(), y.data(), y.size(), q);
+    for (size_t i = y.size(); carry != 0; i++) {
+        r[i] += carry;
+        carry = r[i] < carry;
+    }
+    trim(r);
+    return r;
+}
+
+uint32_t abs_limb(int64_t a) {
+    return static_cast<uint32_t>(a < 0 ? -a : a);
+}
+
+struct lehmer_matrix {
+    int64_t a, b, c, d;
+};
+
+// Knuth's Algorithm L on the leading bits x >= y of two numbers: runs Euclid
+// as long as both bounds on the true quotient agree and the cofactors fit in
+// a limb. b == 0 means no step could be certified.
+lehmer_matrix lehmer(int64_t x, int64_t y) {
+    static const int64_t LIMIT = INT32_MAX;
+    lehmer_matrix m = {1, 0, 0, 1};
+    while (y + m.c > 0 && y + m.d > 0) {
+        int64_t q = (x + m.a) / (y + m.c);
+        if (q != (x + m.b) / (y + m.d) || q > LIMIT) {
+            break;
+        }
+        int64_t c = m.a - q * m.c;
+        int64_t d = m.b - q * m.d;
+        if (c > LIMIT || c < -LIMIT || d > LIMIT || d < -LIMIT) {
+            break;
+        }
+        m = lehmer_matrix{m.c, m.d, c, d};
+        int64_t t = x - q * y;
+        x = y;
+        y = t;
+    }
+    return m;
+}
+
+// Cofactors along the remainder sequence of |a| and |b|:
+//   u = (-1)^odd * (su * |a| - tu * |b|),  v = -(-1)^odd * (sv * |a| - tv * |b|).
+// The signs alternate, so only magnitudes are stored and every update is an
+// addition.
+struct cofactors {
+    limbs su, sv, tu, tv;
+    bool odd;
+
+    void euclid_step(big_integer const& q) {
+        step(su, sv, q);
+        step(tu, tv, q);
+        odd = !odd;
+    }
+
+    void matrix_step(lehmer_matrix const& m) {
+        step(su, sv, m);
+        step(tu, tv, m);
+        odd ^= m.d < 0;
+    }
+
+private:
+    static void step(limbs& x, limbs& y, big_integer const& q) {
+        x.swap(y);
+        y = magnitude(q * from_limbs(x, false) + from_limbs(y, false));
+    }
+
+    static void step(limbs& x, limbs& y, lehmer_matrix const& m) {
+        limbs nx = mul_add(x, abs_limb(m.a), y, abs_limb(m.b));
+        y = mul_add(x, abs_limb(m.c), y, abs_limb(m.d));
+        x.swap(nx);
+    }
+};
+
+// Reduces u >= v until v fits in two limbs, keeping gcd(u, v) and updating
+// the cofactors if given.
+void lehmer_reduce(limbs& u, limbs& v, cofactors* s) {
+    while (v.size() > 2) {
+        size_t from = SHIFT * u.size() - leading_zeros(u.back()) - 62;
+        lehmer_matrix m = lehmer(static_cast<int64_t>(bits_at(u, from)),
+                                 static_cast<int64_t>(bits_at(v, from)));
+        if (m.b == 0) {
+            std::pair<big_integer, big_integer> qr =
+                    big_divisor(from_limbs(v, false)).divmod(from_limbs(u, false));
+            u.swap(v);
+            v = magnitude(qr.second);
+            if (s) {
+                s->euclid_step(qr.first);
+            }
+        } else {
+            limbs nu = combine(u, m.a, v, m.b);
+            v = combine(u, m.c, v, m.d);
+            u.swap(nu);
+            if (s) {
+                s->matrix_step(m);
+            }
+        }
+    }
+}
+
+uint64_t binary_gcd(uint64_t a, uint64_t b) {
+    if (a == 0 || b == 0) {
+        return a | b;
+    }
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            std::swap(a, b);
+        }
+        b -= a;
+    }
+    return a << shift;
+}
+
+uint64_t to_word(limbs const& a) {
+    return a.size() > 1 ? (static_cast<uint64_t>(a[1]) << SHIFT) | a[0] : a[0];
+}
+
+limbs from_word(uint64_t a) {
+    limbs r(2);
+    r[0] = static_cast<uint32_t>(a);
+    r[1] = static_cast<uint32_t>(a >> SHIFT);
+    trim(r);
+    return r;
+}
+
+// Whether x^k <= a, without overflowing.
+bool power_at_most(uint64_t x, unsigned k, uint64_t a) {
+    uint64_t p = 1;
+    for (unsigned i = 0; i < k; i++) {
+        if (__builtin_mul_overflow(p, x, &p) || p > a) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t mul_size(size_t a, uint64_t b) {
+    size_t r;
+    if (__builtin_mul_overflow(a, b, &r)) {
+        throw std::length_error("pow result too large");
+    }
+    return r;
+}
+
+// odd^exp for odd > 1, as limbs. Intermediate powers never exceed the final
+// one, so two buffers of bits / 32 + 2 limbs hold every square and product.
+limbs odd_pow(limbs const& odd, uint64_t exp) {
+    size_t cap = mul_size(SHIFT * odd.size() - leading_zeros(odd.back()), exp) / SHIFT + 2;
+    limbs x(cap), t(cap);
+    std::copy(odd.begin(), odd.end(), x.begin());
+    size_t n = odd.size();
+    for (int bit = 62 - __builtin_clzll(exp); bit >= 0; bit--) {
+        check_cancelled();
+        sqr_n_parallel(t.data(), x.data(), n);
+        x.swap(t);
+        n = 2 * n - (x[2 * n - 1] == 0);
+        if ((exp >> bit) & 1U) {
+            if (odd.size() == 1) {
+                x[n] = mul_1(x.data(), x.data(), n, odd[0]);
+                n++;
+            } else {
+                mul_n_parallel(t.data(), x.data(), n, odd.data(), odd.size());
+                x.swap(t);
+                n += odd.size();
+            }
+            n -= x[n - 1] == 0;
+        }
+    }
+    x.resize(n);
+    return x;
+}
+
+uint64_t word_root(uint64_t a, unsigned k) {
+    uint64_t x = static_cast<uint64_t>(std::pow(static_cast<double>(a), 1.0 / k));
+    while (x > 0 && !power_at_most(x, k, a)) {
+        x--;
+    }
+    while (power_at_most(x + 1, k, a)) {
+        x++;
+    }
+    return x;
+}
+
+// Root of a > 0: the root of a with its low k * s bits dropped carries half of
+// the final precision; shifted back up by one it is an overestimate, from
+// which integer Newton steps descend to the floor. When k is too large for any
+// bits to be dropped, the root has at most a couple of bits and the step
+// starts from 2^ceil(bits / k) instead.
+big_integer root_magnitude(big_integer const& a, unsigned k) {
+    size_t bits = bit_length(a);
+    if (bits <= 2 * SHIFT) {
+        limbs m = magnitude(a);
+        return from_limbs(from_word(word_root(to_word(m), k)), false);
+    }
+    if (k >= bits) {
+        return 1;
+    }
+    int s = static_cast<int>(bits / (2 * k));
+    big_integer x = s == 0 ? big_integer(1) << static_cast<int>((bits + k - 1) / k)
+                           : (root_magnitude(a >> (s * static_cast<int>(k)), k) + 1) << s;
+    while (true) {
+        big_integer y = k == 2 ? (x + a / x) >> 1 : ((k - 1) * x + a / pow(x, k - 1)) / k;
+        if (y >= x) {
+            return x;
+        }
+        x = y;
+    }
+}
+
+// Product of a run of words: short runs go through mul_1, long ones split in
+// half so the top products are balanced.
+limbs word_product(uint32_t const* first, size_t n) {
+    if (n <= 16) {
+        limbs res(n + 1, 0);
+        res[0] = 1;
+        size_t len = 1;
+        for (size_t i = 0; i < n; i++) {
+            res[len] = mul_1(res.data(), res.data(), len, first[i]);
+            len += res[len] != 0;
+        }
+        res.resize(len);
+        return res;
+    }
+    limbs a = word_product(first, n / 2), b = word_product(first + n / 2, n - n / 2);
+    limbs res(a.size() + b.size());
+    mul_n_parallel(res.data(), a.data(), a.size(), b.data(), b.size());
+    trim(res);
+    return res;
+}
+
+// Appends the factors to words, packing neighbours while their product fits.
+void push_factor(limbs& words, uint64_t x) {
+    if (!words.empty() && static_cast<uint64_t>(words.back()) * x <= UINT32_MAX) {
+        words.back() *= static_cast<uint32_t>(x);
+    } else {
+        words.push_back(static_cast<uint32_t>(x));
+    }
+}
+
+limbs odd_range_product(uint32_t from, uint32_t to) {
+    limbs words;
+    for (uint64_t k = from | 1U; k <= to; k += 2) {
+        push_factor(words, k);
+    }
+    return word_product(words.data(), words.size());
+}
+
+size_t window_size(size_t bits) {
+    static const size_t limits[] = {8, 24, 80, 240, 672};
+    size_t k = 1;
+    while (k < 6 && bits > limits[k - 1]) {
+        k++;
+    }
+    return k;
+}
+
+// Arithmetic modulo an odd m on values kept in Montgomery form a * 2^(32n) mod m,
+// where n is the limb count of m. All buffers have exactly n limbs, so the
+// exponentiation loop never allocates.
+class montgomery_ring {
+public:
+    typedef std::vector<uint32_t> value;
+
+    montgomery_ring(big_integer const& m, big_divisor const& d)
+        : d(d)
+        , mod(m.num.data(), m.num.data() + m.num.size())
+        , minv(-binvert_limb(mod[0]))
+        , scratch(2 * mod.size() + 1) {}
+
+    value to_form(big_integer const& a) const {
+        std::vector<uint32_t> shifted(mod.size(), 0);
+        shifted.insert(shifted.end(), a.num.data(), a.num.data() + a.num.size());
+        big_integer r = d.mod(from_limbs(std::move(shifted), false));
+        value res(mod.size(), 0);
+        std::copy(r.num.data(), r.num.data() + r.num.size(), res.begin());
+        return res;
+    }
+
+    big_integer from_form(value const& a) const {
+        value unit(mod.size(), 0);
+        unit[0] = 1;
+        value res(mod.size());
+        mul(res, a, unit);
+        return from_limbs(std::move(res), false);
+    }
+
+    value one() const {
+        return to_form(1);
+    }
+
+    void mul(value& r, value const& a, value const& b) const {
+        size_t n = mod.size();
+        uint32_t* t = scratch.data();
+        std::fill(scratch.begin(), scratch.end(), 0);
+        for (size_t i = 0; i < n; i++) {
+            t[i + n] = addmul_1(t + i, a.data(), n, b[i]);
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t carry = addmul_1(t + i, mod.data(), n, t[i] * minv);
+            for (size_t j = i + n; carry != 0; j++) {
+                carry += t[j];
+                t[j] = static_cast<uint32_t>(carry);
+                carry >>= SHIFT;
+            }
+        }
+        if (t[2 * n] != 0 || cmp_n(t + n, mod.data(), n) >= 0) {
+            sub_n(t + n, t + n, mod.data(), n);
+        }
+        std::copy(t + n, t + 2 * n, r.begin());
+    }
+
+private:
+    big_divisor d;
+    std::vector<uint32_t> mod;
+    uint32_t minv;
+    mutable std::vector<uint32_t> scratch;
+};
+
+// Plain multiply-then-reduce, used when Montgomery form is unavailable (even m).
+class division_ring {
+public:
+    typedef big_integer value;
+
+    explicit division_ring(big_divisor const& d)
+        : d(d) {}
+
+    value one() const {
+        return d.mod(1);
+    }
+
+    void mul(value& r, value const& a, value const& b) const {
+        r = d.mod(a * b);
+    }
+
+private:
+    big_divisor const& d;
+};
+
+// Left-to-right sliding window exponentiation: odd powers base^1 .. base^(2^k - 1)
+// are tabulated once, then every window of up to k bits ending in a one costs
+// its squarings plus a single multiplication.
+template <typename Ring>
+typename Ring::value window_pow(Ring const& ring, typename Ring::value const& base,
+                                big_integer const& exp) {
+    typedef typename Ring::value value;
+    size_t bits = bit_length(exp);
+    size_t k = window_size(bits);
+    std::vector<value> odd(size_t(1) << (k - 1), base);
+    if (odd.size() > 1) {
+        value sq = base;
+        ring.mul(sq, base, base);
+        for (size_t i = 1; i < odd.size(); i++) {
+            ring.mul(odd[i], odd[i - 1], sq);
+        }
+    }
+    value res = ring.one();
+    bool started = false;
+    for (size_t i = bits; i > 0;) {
+        if (!test_bit(exp, i - 1)) {
+            if (started) {
+                ring.mul(res, res, res);
+            }
+            i--;
+            continue;
+        }
+        size_t j = i > k ? i - k : 0;
+        while (!test_bit(exp, j)) {
+            j++;
+        }
+        size_t w = 0;
+        for (size_t b = i; b > j; b--) {
+            w = (w << 1) | test_bit(exp, b - 1);
+        }
+        if (started) {
+            for (size_t b = j; b < i; b++) {
+                ring.mul(res, res, res);
+            }
+            ring.mul(res, res, odd[w >> 1]);
+        } else {
+            res = odd[w >> 1];
+            started = true;
+        }
+        i = j;
+    }
+    return res;
+}
+
+limbs product(limbs const& a, limbs const& b) {
+    limbs r(a.size() + b.size());
+    mul_n(r.data(), a.data(), a.size(), b.data(), b.size());
+    trim(r);
+    return r;
+}
+
+limbs sum(limbs const& a, limbs const& b) {
+    limbs const& x = a.size() < b.size() ? b : a;
+    limbs const& y = a.size() < b.size() ? a : b;
+    limbs r(x.size() + 1);
+    r[x.size()] = add(r.data(), x.data(), x.size(), y.data(), y.size());
+    trim(r);
+    return r;
+}
+
+// a -= b, or false (a unchanged) if that is negative.
+bool subtract(limbs& a, limbs const& b) {
+    if (less(a, b)) {
+        return false;
+    }
+    sub(a.data(), a.data(), a.size(), b.data(), b.size());
+    trim(a);
+    return true;
+}
+
+size_t bit_length(limbs const& a) {
+    return SHIFT * a.size() - leading_zeros(a.back());
+}
+
+// a >> p, a mod 2^p and a << p.
+limbs high_bits(limbs const& a, size_t p) {
+    size_t i = p / SHIFT;
+    if (i >= a.size()) {
+        return limbs(1, 0);
+    }
+    limbs r(a.size() - i);
+    rshift(r.data(), a.data() + i, r.size(), p % SHIFT);
+    trim(r);
+    return r;
+}
+
+limbs low_bits(limbs const& a, size_t p) {
+    limbs r(a.begin(), a.begin() + std::min(a.size(), (p + SHIFT - 1) / SHIFT));
+    if (r.size() == (p + SHIFT - 1) / SHIFT && p % SHIFT != 0) {
+        r.back() &= (1U << (p % SHIFT)) - 1;
+    }
+    if (r.empty()) {
+        r.push_back(0);
+    }
+    trim(r);
+    return r;
+}
+
+limbs shifted(limbs const& a, size_t p) {
+    limbs r(p / SHIFT + a.size() + 1);
+    r.back() = lshift(r.data() + p / SHIFT, a.data(), a.size(), p % SHIFT);
+    trim(r);
+    return r;
+}
+
+// Product of the steps a -= q * b and b -= q * a applied to a pair so far:
+// the original pair is M * (a, b). The entries m00, m01, m10, m11 are
+// non-negative and the determinant is 1, so M^-1 = ((m11, -m01), (-m10, m00)).
+struct hgcd_matrix {
+    limbs m[4];
+
+    static hgcd_matrix identity() {
+        return hgcd_matrix{{limbs(1, 1), limbs(1, 0), limbs(1, 0), limbs(1, 1)}};
+    }
+
+    void operator*=(hgcd_matrix const& r) {
+        hgcd_matrix p = {{sum(product(m[0], r.m[0]), product(m[1], r.m[2])),
+                          sum(product(m[0], r.m[1]), product(m[1], r.m[3])),
+                          sum(product(m[2], r.m[0]), product(m[3], r.m[2])),
+                          sum(product(m[2], r.m[1]), product(m[3], r.m[3]))}};
+        *this = p;
+    }
+
+    // The step a -= q * b (b -= q * a if swap) on the right.
+    void add_quotient(limbs const& q, bool swap) {
+        for (int row = 0; row < 4; row += 2) {
+            limbs& to = m[row + !swap];
+            to = sum(to, product(q, m[row + swap]));
+        }
+    }
+
+    // (a, b) = 2^p * (ha, hb) + M^-1 * (a, b), or false if either would be
+    // negative. With p = 0 and zero tops this is plain M^-1 * (a, b).
+    bool reduce(limbs& a, limbs& b, limbs const& ha, limbs const& hb, size_t p) const {
+        limbs ra = sum(shifted(ha, p), product(m[3], a)), rb = sum(shifted(hb, p), product(m[0], b));
+        if (!subtract(ra, product(m[1], b)) || !subtract(rb, product(m[2], a))) {
+            return false;
+        }
+        a.swap(ra);
+        b.swap(rb);
+        return true;
+    }
+};
+
+// One step that keeps both operands at least 2^s: the larger loses the
+// largest multiple of the smaller that leaves it there. False if there is
+// none.
+bool hgcd_step(limbs& a, limbs& b, hgcd_matrix& m, size_t s) {
+    bool swap = less(a, b);
+    limbs& x = swap ? b : a;
+    limbs& y = swap ? a : b;
+    limbs d = x;
+    subtract(d, y);
+    if (bit_length(d) <= s) {
+        return false;
+    }
+    big_integer floor = big_integer(1) << static_cast<int>(s);
+    limbs q = magnitude(big_divisor(from_limbs(y, false)).divmod(from_limbs(x, false) - floor).first);
+    subtract(x, product(q, y));
+    m.add_quotient(q, swap);
+    return true;
+}
+
+// The steps of hgcd on two words. Both stay at least 2^(bits / 2 + 1), so
+// for 64-bit inputs every entry of the matrix fits in 31 bits.
+struct word_matrix {
+    uint32_t m00, m01, m10, m11;
+};
+
+word_matrix word_hgcd(uint64_t a, uint64_t b) {
+    word_matrix m = {1, 0, 0, 1};
+    int s = (64 - __builtin_clzll(std::max(a, b) | 1U)) / 2 + 1;
+    uint64_t floor = uint64_t(1) << s;
+    if (a < floor || b < floor) {
+        return m;
+    }
+    while (true) {
+        if (a > b) {
+            if (a - b < floor) {
+                break;
+            }
+            uint64_t q = (a - floor) / b;
+            a -= q * b;
+            m.m01 += static_cast<uint32_t>(q) * m.m00;
+            m.m11 += static_cast<uint32_t>(q) * m.m10;
+        } else {
+            if (b - a < floor) {
+                break;
+            }
+            uint64_t q = (b - floor) / a;
+            b -= q * a;
+            m.m00 += static_cast<uint32_t>(q) * m.m01;
+            m.m10 += static_cast<uint32_t>(q) * m.m11;
+        }
+    }
+    return m;
+}
+
+// r = p * x - q * y, or false if that is negative.
+bool checked_mul_sub(limbs& r, limbs const& x, uint32_t p, limbs const& y, uint32_t q) {
+    r.assign(std::max(x.size(), y.size()) + 1, 0);
+    r[x.size()] = mul_1(r.data(), x.data(), x.size(), p);
+    uint32_t borrow = submul_1(r.data(), y.data(), y.size(), q);
+    for (size_t i = y.size(); borrow != 0 && i < r.size(); i++) {
+        uint32_t old = r[i];
+        r[i] -= borrow;
+        borrow = old < borrow;
+    }
+    trim(r);
+    return borrow == 0;
+}
+
+// The steps of hgcd at bound s done like Lehmer's algorithm: the bits of
+// both operands above max(2^s, their top 64 bits) are reduced with word_hgcd
+// and the matrix applied to the full numbers at once. When that makes no
+// progress, or would take an operand below 2^s, one exact step is taken
+// instead.
+bool hgcd_lehmer(limbs& a, limbs& b, hgcd_matrix& m, size_t s) {
+    limbs ra, rb;
+    bool progress = false;
+    while (true) {
+        size_t n = std::max(bit_length(a), bit_length(b));
+        size_t p = std::max(s, n > 64 ? n - 64 : 0);
+        word_matrix w = word_hgcd(bits_at(a, p), bits_at(b, p));
+        if ((w.m01 != 0 || w.m10 != 0) && checked_mul_sub(ra, a, w.m11, b, w.m01) &&
+            checked_mul_sub(rb, b, w.m00, a, w.m10) && bit_length(ra) > s && bit_length(rb) > s) {
+            a.swap(ra);
+            b.swap(rb);
+            for (int row = 0; row < 4; row += 2) {
+                limbs m0 = mul_add(m.m[row], w.m00, m.m[row + 1], w.m10);
+                m.m[row + 1] = mul_add(m.m[row], w.m01, m.m[row + 1], w.m11);
+                m.m[row].swap(m0);
+            }
+        } else if (!hgcd_step(a, b, m, s)) {
+            return progress;
+        }
+        progress = true;
+    }
+}
+
+// Möller's half GCD: for a, b of at most n bits, applies the remainder steps
+// that keep both at least 2^s, s = n / 2 + 1, and accumulates them in m.
+// Each half of the work is a recursive call on the bits of the current pair
+// above some p, whose matrix then only has to be applied to the bits below
+// p. The results are checked, so a matrix that does not carry over to the
+// full numbers is simply dropped. False if no step was possible.
+bool hgcd(limbs& a, limbs& b, hgcd_matrix& m) {
+    check_cancelled();
+    size_t n = std::max(bit_length(a), bit_length(b));
+    size_t s = n / 2 + 1;
+    m = hgcd_matrix::identity();
+    if (bit_length(a) <= s || bit_length(b) <= s) {
+        return false;
+    }
+    bool progress = false;
+    if (n > HGCD_BASE_THRESHOLD * SHIFT) {
+        for (int half = 0; half < 2; half++) {
+            size_t now = std::max(bit_length(a), bit_length(b));
+            // The second call splits so that its own bound lands back on s.
+            size_t p = half == 0 || now + 1 >= 2 * s ? s : 2 * s - now + 1;
+            if (now <= p + 2) {
+                break;
+            }
+            limbs ha = high_bits(a, p), hb = high_bits(b, p);
+            hgcd_matrix sub;
+            if (hgcd(ha, hb, sub)) {
+                limbs ra = low_bits(a, p), rb = low_bits(b, p);
+                if (sub.reduce(ra, rb, ha, hb, p) && bit_length(ra) > s && bit_length(rb) > s) {
+                    a.swap(ra);
+                    b.swap(rb);
+                    m *= sub;
+                    progress = true;
+                }
+            }
+            if (half == 0) {
+                progress |= hgcd_step(a, b, m, s);
+            }
+        }
+    }
+    progress |= hgcd_lehmer(a, b, m, s);
+    return progress;
+}
+
+// Shrinks a, b with half-GCD rounds, each followed by one plain division
+// step, until the smaller is below HGCD_THRESHOLD limbs. With m, the steps
+// are accumulated there as well.
+void hgcd_reduce(limbs& a, limbs& b, hgcd_matrix* m) {
+    while (std::min(a.size(), b.size()) >= HGCD_THRESHOLD) {
+        hgcd_matrix step;
+        if (hgcd(a, b, step) && m) {
+            *m *= step;
+        }
+        bool swap = less(a, b);
+        limbs& x = swap ? b : a;
+        limbs& y = swap ? a : b;
+        std::pair<big_integer, big_integer> qr = big_divisor(from_limbs(y, false)).divmod(from_limbs(x, false));
+        x = magnitude(qr.second);
+        if (m) {
+            m->add_quotient(magnitude(qr.first), swap);
+        }
+    }
+}
+
+}
+
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod) {
+    if (exp.sign) {
+        throw std::invalid_argument("negative exponent");
+    }
+    big_integer m = mod;
+    m.sign = false;
+    big_divisor d(m);
+    big_integer b = d.mod(base);
+    if (b.sign) {
+        b += m;
+    }
+    if (m.num[0] & 1U) {
+        montgomery_ring ring(m, d);
+        return ring.from_form(window_pow(ring, ring.to_form(b), exp));
+    }
+    return window_pow(division_ring(d), b, exp);
+}
+
+big_integer gcd(big_integer const& a, big_integer const& b) {
+    limbs u = magnitude(a), v = magnitude(b);
+    hgcd_reduce(u, v, nullptr);
+    if (less(u, v)) {
+        u.swap(v);
+    }
+    lehmer_reduce(u, v, nullptr);
+    uint64_t y = to_word(v);
+    if (y == 0) {
+        return from_limbs(u, false);
+    }
+    uint64_t x = to_word(magnitude(big_divisor(from_limbs(v, false)).mod(from_limbs(u, false))));
+    return from_limbs(from_word(binary_gcd(x, y)), false);
+}
+
+big_integer xgcd(big_integer const& a, big_integer const& b, big_integer& x, big_integer& y) {
+    limbs u = magnitude(a), v = magnitude(b);
+    hgcd_matrix m = hgcd_matrix::identity();
+    hgcd_reduce(u, v, &m);
+    cofactors s = {limbs(1, 1), limbs(1, 0), limbs(1, 0), limbs(1, 1), false};
+    if (less(u, v)) {
+        u.swap(v);
+        s.su.swap(s.sv);
+        s.tu.swap(s.tv);
+        s.odd = true;
+    }
+    lehmer_reduce(u, v, &s);
+    while (v.size() > 1 || v[0] != 0) {
+        std::pair<big_integer, big_integer> qr =
+                big_divisor(from_limbs(v, false)).divmod(from_limbs(u, false));
+        u.swap(v);
+        v = magnitude(qr.second);
+        s.euclid_step(qr.first);
+    }
+    // g = xr * ra + yr * rb for the pair (ra, rb) = M^-1 * (|a|, |b|) that
+    // hgcd_reduce left.
+    big_integer xr = from_limbs(s.su, s.odd), yr = from_limbs(s.tu, !s.odd);
+    x = xr * from_limbs(m.m[3], false) - yr * from_limbs(m.m[2], false);
+    y = yr * from_limbs(m.m[0], false) - xr * from_limbs(m.m[1], false);
+    if (a.sign) {
+        x = -x;
+    }
+    if (b.sign) {
+        y = -y;
+    }
+    return from_limbs(u, false);
+}
+
+big_integer invert(big_integer const& a, big_integer const& m) {
+    big_integer mod = m;
+    mod.sign = false;
+    big_divisor d(mod);
+    big_integer x, y;
+    if (xgcd(a, mod, x, y) != 1) {
+        throw std::invalid_argument("not invertible");
+    }
+    x = d.mod(x);
+    if (x.sign) {
+        x += mod;
+    }
+    return x;
+}
+
+big_integer isqrt(big_integer const& a) {
+    return iroot(a, 2);
+}
+
+big_integer iroot(big_integer const& a, unsigned k) {
+    if (k == 0) {
+        throw std::invalid_argument("zeroth root");
+    }
+    if (a.sign && k % 2 == 0) {
+        throw std::invalid_argument("even root of negative number");
+    }
+    if (k == 1 || a == 0) {
+        return a;
+    }
+    big_integer abs = a;
+    abs.sign = false;
+    big_integer res = root_magnitude(abs, k);
+    res.sign = a.sign;
+    return res;
+}
+
+big_integer pow(big_integer const& base, uint64_t exp) {
+    if (exp == 0) {
+        return 1;
+    }
+    if (base == 0) {
+        return 0;
+    }
+    limbs b = magnitude(base);
+    size_t zeros = 0;
+    while (b[zeros / SHIFT] == 0) {
+        zeros += SHIFT;
+    }
+    zeros += __builtin_ctz(b[zeros / SHIFT]);
+    limbs odd(b.size() - zeros / SHIFT);
+    rshift(odd.data(), b.data() + zeros / SHIFT, odd.size(), zeros % SHIFT);
+    trim(odd);
+    size_t shift = mul_size(zeros, exp);
+    limbs p = odd.size() == 1 && odd[0] == 1 ? odd : odd_pow(odd, exp);
+    limbs res(shift / SHIFT + p.size() + 1, 0);
+    res.back() = lshift(res.data() + shift / SHIFT, p.data(), p.size(), shift % SHIFT);
+    return from_limbs(std::move(res), base.sign && (exp & 1U));
+}
+
+big_integer factorial(uint32_t n) {
+    limbs odd(1, 1), res(1, 1);
+    uint32_t done = 1;
+    for (int i = 31 - leading_zeros(n | 1U); i >= 0; i--) {
+        uint32_t h = n >> i;
+        if (h > done) {
+            limbs range = odd_range_product(done + 1, h);
+            limbs next(odd.size() + range.size());
+            mul_n_parallel(next.data(), odd.data(), odd.size(), range.data(), range.size());
+            trim(next);
+            odd.swap(next);
+            done = h;
+        }
+        limbs next(res.size() + odd.size());
+        mul_n_parallel(next.data(), res.data(), res.size(), odd.data(), odd.size());
+        trim(next);
+        res.swap(next);
+    }
+    return from_limbs(std::move(res), false) << static_cast<int>(n - __builtin_popcount(n));
+}
+
+big_integer binomial(uint32_t n, uint32_t k) {
+    if (k > n) {
+        return 0;
+    }
+    k = std::min(k, n - k);
+    if (static_cast<uint64_t>(k) * k / BINOMIAL_SIEVE_RATIO < n) {
+        limbs words;
+        for (uint64_t x = static_cast<uint64_t>(n) - k + 1; x <= n; x++) {
+            push_factor(words, x);
+        }
+        return divexact(from_limbs(word_product(words.data(), words.size()), false), factorial(k));
+    }
+    std::vector<bool> composite(static_cast<size_t>(n) + 1);
+    limbs words;
+    for (uint64_t p = 2; p <= n; p++) {
+        if (composite[p]) {
+            continue;
+        }
+        for (uint64_t q = p * p; q <= n; q += p) {
+            composite[q] = true;
+        }
+        if (p > n - k) {
+            push_factor(words, p);
+            continue;
+        }
+        if (2 * p > n) {
+            continue;
+        }
+        for (uint64_t q = p; q <= n; q *= p) {
+            if ((n / q) - (k / q) - ((n - k) / q) != 0) {
+                push_factor(words, p);
+            }
+        }
+    }
+    return from_limbs(word_product(words.data(), words.size()), false);
+}
@@ -0,0 +1,60 @@
+#ifndef BIGINT_NUMBER_THEORY_H
+#define BIGINT_NUMBER_THEORY_H
+
+#include <cstdint>
+#include <iterator>
+#include "big_integer.h"
+
+// base^exp mod |mod|, in [0, |mod|). Odd moduli use Montgomery multiplication.
+big_integer powmod(big_integer const& base, big_integer const& exp, big_integer const& mod);
+
+// Greatest common divisor, always non-negative. Operands of a thousand limbs
+// and more are first shrunk with Moller's half GCD, which is subquadratic on
+// top of mul_n; the rest is reduced with Lehmer steps on the leading 62 bits
+// and the last word with binary GCD. xgcd takes the same path.
+big_integer gcd(big_integer const& a, big_integer const& b);
+
+// Returns gcd(a, b) and sets x, y so that a * x + b * y == gcd(a, b).
+big_integer xgcd(big_integer const& a, big_integer const& b, big_integer& x, big_integer& y);
+
+// Inverse of a modulo |m|, in [0, |m|); throws if gcd(a, m) != 1.
+big_integer invert(big_integer const& a, big_integer const& m);
+
+// base^exp. Factors of two in base become a single shift; the remaining odd
+// part is raised by left-to-right binary exponentiation on the squaring
+// kernel, in buffers sized once from bit_length(base) * exp.
+big_integer pow(big_integer const& base, uint64_t exp);
+
+// Product of [first, last) as a balanced tree, so that the large products
+// pair up operands of similar size and reach the Karatsuba range.
+template <typename It>
+big_integer product(It first, It last) {
+    size_t n = std::distance(first, last);
+    if (n == 0) {
+        return 1;
+    }
+    if (n == 1) {
+        return *first;
+    }
+    It mid = first;
+    std::advance(mid, n / 2);
+    return product(first, mid) * product(mid, last);
+}
+
+// n! as its odd part times a power of two; the odd part is a product of
+// products of odd numbers in ranges (n / 2^(i+1), n / 2^i].
+big_integer factorial(uint32_t n);
+
+// C(n, k) as the product tree of its prime factorization (Legendre's formula),
+// or, when k is small next to n, as n (n - 1) ... (n - k + 1) / k!.
+big_integer binomial(uint32_t n, uint32_t k);
+
+// floor(sqrt(a)) for a >= 0.
+big_integer isqrt(big_integer const& a);
+
+// k-th root of a rounded toward zero; a may be negative only for odd k.
+// Newton iteration from a double-precision seed on the top bits, with the
+// precision doubled at each level.
+big_integer iroot(big_integer const& a, unsigned k);
+
+#endif //BIGINT_NUMBER_THEORY_H
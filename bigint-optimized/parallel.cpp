@@ -0,0 +1,296 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <pthread.h>
+#include <sched.h>
+
+unsigned default_threads() {
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+        return static_cast<unsigned>(std::max(CPU_COUNT(&cpus), 1));
+    }
+    return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
+namespace {
+
+// The pool and deque of the worker running on this thread, if any.
+thread_local thread_pool const* current_pool = nullptr;
+thread_local size_t current_deque = 0;
+// The flag of the cancellation scope this thread is in.
+thread_local std::atomic<bool> const* cancel_flag = nullptr;
+// The shared pool of the operation running on this thread, set by task_group
+// for its lifetime and for the tasks it runs, so that nested parallel code
+// does not go through shared_pool_lock again.
+thread_local thread_pool* operation_pool = nullptr;
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> res;
+    cpu_set_t cpus;
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            if (CPU_ISSET(i, &cpus)) {
+                res.push_back(i);
+            }
+        }
+    }
+    return res;
+}
+
+}
+
+thread_pool::thread_pool(unsigned threads, bool pin)
+    : count(std::max(threads, 1U))
+    , pin(pin)
+    , queued(0)
+    , stopping(false) {
+    for (unsigned i = 0; i < count; i++) {
+        deques.emplace_back(new task_deque);
+    }
+    std::vector<int> cpus = pin ? allowed_cpus() : std::vector<int>();
+    for (unsigned i = 0; i + 1 < count; i++) {
+        workers.emplace_back(&thread_pool::work, this, i, cpus.empty() ? -1 : cpus[i % cpus.size()]);
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+unsigned thread_pool::threads() const {
+    return count;
+}
+
+bool thread_pool::pinned() const {
+    return pin;
+}
+
+void thread_pool::submit(std::function<void()> task) {
+    task_deque& own = *deques[own_deque()];
+    {
+        // Counted before the lock is released, so a thief that takes the
+        // task never decrements ahead of it.
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.tasks.push_back(std::move(task));
+        queued++;
+    }
+    {
+        std::lock_guard<std::mutex> guard(sleep_lock);
+    }
+    wake.notify_one();
+}
+
+bool thread_pool::run_one() {
+    std::function<void()> task;
+    if (!take(own_deque(), task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+size_t thread_pool::own_deque() const {
+    return current_pool == this ? current_deque : count - 1;
+}
+
+bool thread_pool::take(size_t self, std::function<void()>& task) {
+    if (queued == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        task_deque& victim = *deques[(self + i) % count];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            if (i == 0) {
+                task = std::move(victim.tasks.back());
+                victim.tasks.pop_back();
+            } else {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void thread_pool::work(size_t index, int cpu) {
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    current_pool = this;
+    current_deque = index;
+    for (;;) {
+        std::function<void()> task;
+        if (take(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        wake.wait(guard, [this] { return stopping || queued != 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+namespace {
+
+std::mutex shared_pool_lock;
+std::unique_ptr<thread_pool> shared_pool_instance;
+
+thread_pool& shared_pool_locked() {
+    if (!shared_pool_instance) {
+        shared_pool_instance.reset(new thread_pool(default_threads()));
+    }
+    return *shared_pool_instance;
+}
+
+}
+
+thread_pool& shared_pool() {
+    if (operation_pool) {
+        return *operation_pool;
+    }
+    std::lock_guard<std::mutex> guard(shared_pool_lock);
+    return shared_pool_locked();
+}
+
+void set_shared_pool_threads(unsigned threads) {
+    std::lock_guard<std::mutex> guard(shared_pool_lock);
+    bool pin = shared_pool_locked().pinned();
+    shared_pool_instance.reset();
+    shared_pool_instance.reset(new thread_pool(threads == 0 ? default_threads() : threads, pin));
+    // Nothing runs here, but an idle task_group may still have the old pool
+    // remembered for this thread.
+    operation_pool = nullptr;
+}
+
+void set_shared_pool_pinning(bool pin) {
+    std::lock_guard<std::mutex> guard(shared_pool_lock);
+    unsigned threads = shared_pool_locked().threads();
+    shared_pool_instance.reset();
+    shared_pool_instance.reset(new thread_pool(threads, pin));
+    operation_pool = nullptr;
+}
+
+cancellation_token::cancellation_token()
+    : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+void cancellation_token::cancel() const {
+    *flag = true;
+}
+
+bool cancellation_token::cancelled() const {
+    return *flag;
+}
+
+operation_cancelled::operation_cancelled()
+    : std::runtime_error("operation cancelled") {}
+
+cancellation_scope::cancellation_scope(cancellation_token const& token)
+    : saved(cancel_flag) {
+    cancel_flag = token.flag.get();
+}
+
+cancellation_scope::~cancellation_scope() {
+    cancel_flag = saved;
+}
+
+void check_cancelled() {
+    if (cancel_flag && cancel_flag->load(std::memory_order_relaxed)) {
+        throw operation_cancelled();
+    }
+}
+
+task_group::task_group()
+    : pool(shared_pool())
+    , saved_pool(operation_pool)
+    , pending(0) {
+    operation_pool = &pool;
+}
+
+task_group::~task_group() {
+    while (pending != 0) {
+        if (!pool.run_one()) {
+            std::this_thread::yield();
+        }
+    }
+    operation_pool = saved_pool;
+}
+
+void task_group::run(std::function<void()> task) {
+    std::atomic<bool> const* cancel = cancel_flag;
+    if (pool.threads() == 1) {
+        call(task, cancel);
+        return;
+    }
+    pending++;
+    pool.submit([this, task, cancel] {
+        call(task, cancel);
+        pending--;
+    });
+}
+
+void task_group::wait() {
+    while (pending != 0) {
+        if (!pool.run_one()) {
+            std::this_thread::yield();
+        }
+    }
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+// Runs task under the cancellation flag of the thread that submitted it and
+// with the group's pool as the shared one, restoring this thread's own
+// afterwards.
+void task_group::call(std::function<void()> const& task, std::atomic<bool> const* cancel) {
+    std::atomic<bool> const* saved = cancel_flag;
+    thread_pool* outer_pool = operation_pool;
+    cancel_flag = cancel;
+    operation_pool = &pool;
+    try {
+        check_cancelled();
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(error_lock);
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+    cancel_flag = saved;
+    operation_pool = outer_pool;
+}
+
+void parallel_for(size_t n, unsigned threads, std::function<void(size_t)> const& f) {
+    std::atomic<size_t> next(0);
+    task_group tasks;
+    auto drain = [&] {
+        for (size_t i; (i = next++) < n;) {
+            check_cancelled();
+            f(i);
+        }
+    };
+    size_t width = std::min<size_t>(threads == 0 ? shared_pool().threads() : threads, n);
+    for (size_t i = 0; i < width; i++) {
+        tasks.run(drain);
+    }
+    tasks.wait();
+}
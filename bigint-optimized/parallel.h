@@ -0,0 +1,146 @@
+#ifndef BIGINT_PARALLEL_H
+#define BIGINT_PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Fork-join support for the multithreaded algorithms. Tasks must not copy a
+// big_integer another task may copy at the same time, since the reference
+// counts of shared values are not atomic; reading one through a const
+// reference is safe.
+
+// The number of CPUs this process may run on, or 1 if that is unknown.
+unsigned default_threads();
+
+// A work-stealing scheduler. Each worker has a deque of tasks: tasks
+// submitted from a worker go to the back of its own deque and it takes them
+// back newest first, which keeps a recursive algorithm depth-first and in
+// cache, while idle workers steal the oldest, largest tasks from the front
+// of other deques. Threads outside the pool share one more deque. A pool of
+// n threads has n - 1 workers, the thread waiting for the tasks being
+// expected to run them too; with pin set, worker i is bound to the i-th
+// CPU the process may use.
+class thread_pool {
+public:
+    explicit thread_pool(unsigned threads, bool pin = false);
+    ~thread_pool();
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    unsigned threads() const;
+    bool pinned() const;
+    void submit(std::function<void()> task);
+    // Runs a task on the calling thread, its own first and then a stolen
+    // one, returning false if there was none.
+    bool run_one();
+
+private:
+    struct task_deque {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void work(size_t index, int cpu);
+    size_t own_deque() const;
+    bool take(size_t self, std::function<void()>& task);
+
+    unsigned count;
+    bool pin;
+    // One per worker, the last for outside threads.
+    std::vector<std::unique_ptr<task_deque>> deques;
+    std::atomic<size_t> queued;
+    bool stopping;
+    std::mutex sleep_lock;
+    std::condition_variable wake;
+    std::vector<std::thread> workers;
+};
+
+// The scheduler every parallel algorithm submits to, so that they share one
+// set of threads however they nest. It is default_threads() wide and
+// unpinned unless set otherwise; a single thread makes every algorithm
+// serial. Changing a setting replaces the pool and must not happen while
+// any of them is running. Only the first call of an operation takes a lock:
+// inside a task_group, and in the tasks it runs, the pool is remembered.
+thread_pool& shared_pool();
+void set_shared_pool_threads(unsigned threads);
+void set_shared_pool_pinning(bool pin);
+
+// A flag shared by every copy, set to ask a computation to stop.
+class cancellation_token {
+public:
+    cancellation_token();
+
+    void cancel() const;
+    bool cancelled() const;
+
+private:
+    friend class cancellation_scope;
+
+    std::shared_ptr<std::atomic<bool>> flag;
+};
+
+class operation_cancelled : public std::runtime_error {
+public:
+    operation_cancelled();
+};
+
+// Makes token the one check_cancelled consults on this thread until the
+// scope ends. task_group passes it on to the tasks it runs, wherever they
+// run.
+class cancellation_scope {
+public:
+    explicit cancellation_scope(cancellation_token const& token);
+    ~cancellation_scope();
+
+    cancellation_scope(cancellation_scope const&) = delete;
+    cancellation_scope& operator=(cancellation_scope const&) = delete;
+
+private:
+    std::atomic<bool> const* saved;
+};
+
+// Throws operation_cancelled if the computation on this thread has been
+// cancelled. The long-running kernels call it at their recursion steps;
+// outside a cancellation_scope it does nothing.
+void check_cancelled();
+
+// Tasks run on the shared pool and waited for together. While waiting, the
+// thread runs queued tasks itself, so tasks can fork and wait in turn. If
+// tasks throw, wait rethrows the first exception once all have finished.
+class task_group {
+public:
+    task_group();
+    ~task_group();
+
+    task_group(task_group const&) = delete;
+    task_group& operator=(task_group const&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+private:
+    void call(std::function<void()> const& task, std::atomic<bool> const* cancel);
+
+    thread_pool& pool;
+    thread_pool* saved_pool;
+    std::atomic<size_t> pending;
+    std::mutex error_lock;
+    std::exception_ptr error;
+};
+
+// Calls f(0), ..., f(n - 1) on up to threads threads of the shared pool, 0
+// meaning all of them, and returns when all calls have, rethrowing as
+// task_group::wait does. The calls check for cancellation before starting.
+void parallel_for(size_t n, unsigned threads, std::function<void(size_t)> const& f);
+
+#endif //BIGINT_PARALLEL_H
@@ -0,0 +1,635 @@
+#include "radix_conversion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "big_divisor.h"
+#include "limb_arithmetic.h"
+#include "number_theory.h"
+#include "parallel.h"
+
+namespace {
+
+// Below these sizes (limbs for output, words of digits for input) values are
+// converted one machine word of digits at a time.
+const size_t TO_CHARS_DC_THRESHOLD = 40;
+const size_t FROM_CHARS_DC_THRESHOLD = 40;
+// Output pieces of at least this many limbs are split across threads.
+const size_t TO_CHARS_PARALLEL_THRESHOLD = 400;
+
+// incremental_parser converts blocks of word digits << PARSER_BLOCK_LEVEL,
+// a few times the size at which from_chars starts splitting.
+const size_t PARSER_BLOCK_LEVEL = 7;
+
+char const DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+void check_base(int base) {
+    if (base < 2 || base > 36) {
+        throw std::invalid_argument("invalid base");
+    }
+}
+
+// Value of every character as a digit, 36 for those that are none. A table
+// rather than range checks: digits and letters alternate unpredictably in
+// most bases above ten.
+struct digit_table {
+    uint8_t value[256];
+
+    constexpr digit_table()
+        : value() {
+        for (int c = 0; c < 256; c++) {
+            value[c] = c >= '0' && c <= '9' ? c - '0'
+                     : c >= 'a' && c <= 'z' ? c - 'a' + 10
+                     : c >= 'A' && c <= 'Z' ? c - 'A' + 10
+                     : 36;
+        }
+    }
+};
+
+constexpr digit_table DIGIT_VALUES;
+
+uint32_t digit_value(char c) {
+    return DIGIT_VALUES.value[static_cast<unsigned char>(c)];
+}
+
+// The largest power of the base not above limit, and its number of digits.
+struct radix_word {
+    uint64_t value;
+    size_t digits;
+};
+
+radix_word largest_power(int base, uint64_t limit) {
+    radix_word w = {1, 0};
+    while (w.value <= limit / base) {
+        w.value *= base;
+        w.digits++;
+    }
+    return w;
+}
+
+// Writes w as exactly len digits ending at last; decimal gets a constant
+// divisor the compiler can turn into a multiplication.
+template <int Base>
+void write_word(char* last, uint64_t w, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        *--last = DIGITS[w % Base];
+        w /= Base;
+    }
+}
+
+void write_word(char* last, uint64_t w, size_t len, int base) {
+    if (base == 10) {
+        write_word<10>(last, w, len);
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        *--last = DIGITS[w % base];
+        w /= base;
+    }
+}
+
+size_t word_length(uint64_t w, int base) {
+    size_t len = 1;
+    for (; w >= static_cast<uint64_t>(base); w /= base) {
+        len++;
+    }
+    return len;
+}
+
+template <int Base>
+uint64_t read_word(char const* p, size_t len) {
+    uint64_t w = 0;
+    for (size_t i = 0; i < len; i++) {
+        w = w * Base + digit_value(p[i]);
+    }
+    return w;
+}
+
+uint64_t read_word(char const* p, size_t len, int base) {
+    if (base == 10) {
+        return read_word<10>(p, len);
+    }
+    uint64_t w = 0;
+    for (size_t i = 0; i < len; i++) {
+        w = w * base + digit_value(p[i]);
+    }
+    return w;
+}
+
+char const* digits_end(char const* p, char const* last, int base) {
+    while (p != last && digit_value(*p) < static_cast<uint32_t>(base)) {
+        p++;
+    }
+    return p;
+}
+
+// log2 of a power-of-two base, 0 for other bases.
+unsigned digit_bits(int base) {
+    return (base & (base - 1)) == 0 ? __builtin_ctz(base) : 0;
+}
+
+size_t bit_length(big_integer const& x) {
+    size_t n = x.num.size();
+    uint32_t top = x.num[n - 1];
+    return top == 0 ? 0 : (n - 1) * 32 + (32 - leading_zeros(top));
+}
+
+// Whole limbs in bases 2, 4 and 16, where every limb is a fixed run of
+// digits, most significant first. The digits are computed rather than looked
+// up, and reading assumes they are valid, so neither loop branches and both
+// vectorize. As with the big_uint_lanes kernels, GCC on x86-64 Linux also
+// builds AVX2 and AVX-512 versions and the loader picks one.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define BIGINT_DIGIT_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define BIGINT_DIGIT_KERNEL
+#endif
+
+template <unsigned Bits>
+BIGINT_DIGIT_KERNEL void write_limbs(char* p, uint32_t const* a, size_t n) {
+    const unsigned per_limb = 32 / Bits;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t v = a[n - 1 - i];
+        for (unsigned j = 0; j < per_limb; j++) {
+            uint32_t d = (v >> ((per_limb - 1 - j) * Bits)) & ((1U << Bits) - 1);
+            p[i * per_limb + j] = static_cast<char>(d + (d < 10 ? '0' : 'a' - 10));
+        }
+    }
+}
+
+// '0'-'9', 'a'-'f' and 'A'-'F' all have their value in the low nibble, plus
+// nine for the letters, which are the ones with bit 6 set.
+template <unsigned Bits>
+BIGINT_DIGIT_KERNEL void read_limbs(uint32_t* r, char const* p, size_t n) {
+    const unsigned per_limb = 32 / Bits;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t v = 0;
+        for (unsigned j = 0; j < per_limb; j++) {
+            uint32_t c = static_cast<unsigned char>(p[i * per_limb + j]);
+            v |= ((c & 15U) + 9 * (c >> 6)) << ((per_limb - 1 - j) * Bits);
+        }
+        r[n - 1 - i] = v;
+    }
+}
+
+// Power-of-two bases map bits to digits directly, in linear time. When the
+// digit size divides the limb size every limb is a fixed run of digits.
+char* write_pow2(char* first, big_integer const& x, unsigned bits) {
+    uint32_t const* a = x.num.data();
+    size_t n = x.num.size();
+    size_t digits = std::max<size_t>((bit_length(x) + bits - 1) / bits, 1);
+    uint32_t mask = (1U << bits) - 1;
+    char* p = first;
+    if (32 % bits == 0) {
+        size_t per_limb = 32 / bits;
+        size_t head = digits - (n - 1) * per_limb;
+        for (size_t j = head; j-- > 0;) {
+            *p++ = DIGITS[(a[n - 1] >> (j * bits)) & mask];
+        }
+        if (bits == 4) {
+            write_limbs<4>(p, a, n - 1);
+        } else if (bits == 2) {
+            write_limbs<2>(p, a, n - 1);
+        } else {
+            write_limbs<1>(p, a, n - 1);
+        }
+        return p + (n - 1) * per_limb;
+    }
+    for (size_t d = digits; d-- > 0;) {
+        size_t pos = d * bits, limb = pos / 32, offset = pos % 32;
+        uint32_t v = a[limb] >> offset;
+        if (offset + bits > 32 && limb + 1 < n) {
+            v |= a[limb + 1] << (32 - offset);
+        }
+        *p++ = DIGITS[v & mask];
+    }
+    return p;
+}
+
+big_integer read_pow2(char const* first, char const* last, unsigned bits) {
+    std::vector<uint32_t> limbs(((last - first) * bits + 31) / 32);
+    if (32 % bits == 0 && !limbs.empty()) {
+        size_t per_limb = 32 / bits, full = (last - first) / per_limb;
+        char const* head = last - full * per_limb;
+        if (bits == 4) {
+            read_limbs<4>(limbs.data(), head, full);
+        } else if (bits == 2) {
+            read_limbs<2>(limbs.data(), head, full);
+        } else {
+            read_limbs<1>(limbs.data(), head, full);
+        }
+        uint32_t top = 0;
+        for (char const* p = first; p != head; p++) {
+            top = (top << bits) | digit_value(*p);
+        }
+        if (head != first) {
+            limbs[full] = top;
+        }
+        return from_limbs(std::move(limbs), false);
+    }
+    uint64_t acc = 0;
+    unsigned filled = 0;
+    size_t i = 0;
+    for (char const* p = last; p != first;) {
+        acc |= static_cast<uint64_t>(digit_value(*--p)) << filled;
+        filled += bits;
+        if (filled >= 32) {
+            limbs[i++] = static_cast<uint32_t>(acc);
+            acc >>= 32;
+            filled -= 32;
+        }
+    }
+    if (filled != 0) {
+        limbs[i] = static_cast<uint32_t>(acc);
+    }
+    return from_limbs(std::move(limbs), false);
+}
+
+// Output splits at word^(2^level), the largest power of the base below 2^64
+// squared level times; the lower part always has word.digits << level digits.
+// With more than one thread in the shared pool, large pieces are split into
+// tasks writing to disjoint parts of the buffer. Every cache entry a piece
+// can need is filled before the first split, so the tasks only read them.
+class writer {
+public:
+    explicit writer(int base)
+        : base(base)
+        , word(largest_power(base, UINT64_MAX))
+        , parallel(shared_pool().threads() > 1) {}
+
+    // Writes x >= 0 without leading zeros from first, returning the end, or
+    // null if the digits do not fit in [first, last). The range also serves
+    // as scratch, so its contents past the end are unspecified either way.
+    char* write(char* first, char* last, big_integer const& x) {
+        if (x.num.size() < TO_CHARS_DC_THRESHOLD) {
+            return write_small(first, last, x);
+        }
+        check_cancelled();
+        size_t level = 0;
+        while (power(level + 1).num.size() * 2 <= x.num.size()) {
+            level++;
+        }
+        std::pair<big_integer, big_integer> qr = divisor(level).divmod(x);
+        size_t width = word.digits << level;
+        if (static_cast<size_t>(last - first) < width) {
+            return nullptr;
+        }
+        if (!split(x)) {
+            char* p = write(first, last, qr.first);
+            if (!p || static_cast<size_t>(last - p) < width) {
+                return nullptr;
+            }
+            write_fixed(p + width, qr.second, level);
+            return p + width;
+        }
+        // The length of the upper part is not known in advance, so the
+        // lower part goes to the end of the buffer and is moved down after.
+        task_group tasks;
+        tasks.run([&] { write_fixed(last, qr.second, level); });
+        char* p = write(first, last - width, qr.first);
+        tasks.wait();
+        if (!p) {
+            return nullptr;
+        }
+        std::memmove(p, last - width, width);
+        return p + width;
+    }
+
+    // Writes 0 <= x < word^(2^level) as exactly word.digits << level digits
+    // ending at last.
+    void write_fixed(char* last, big_integer const& x, size_t level) {
+        size_t width = word.digits << level;
+        if (level == 0 || x.num.size() < TO_CHARS_DC_THRESHOLD) {
+            write_small_fixed(last, x, width);
+            return;
+        }
+        check_cancelled();
+        std::pair<big_integer, big_integer> qr = divisor(level - 1).divmod(x);
+        if (!split(x)) {
+            write_fixed(last, qr.second, level - 1);
+            write_fixed(last - width / 2, qr.first, level - 1);
+            return;
+        }
+        task_group tasks;
+        tasks.run([&] { write_fixed(last, qr.second, level - 1); });
+        write_fixed(last - width / 2, qr.first, level - 1);
+        tasks.wait();
+    }
+
+private:
+    bool split(big_integer const& x) const {
+        return parallel && x.num.size() >= TO_CHARS_PARALLEL_THRESHOLD;
+    }
+
+    // Every word is at least 2^32, so a value below the threshold yields at
+    // most TO_CHARS_DC_THRESHOLD + 1 of them.
+    char* write_small(char* first, char* last, big_integer x) {
+        uint64_t words[TO_CHARS_DC_THRESHOLD + 1];
+        size_t n = 0;
+        do {
+            words[n++] = divmod_small(x, word.value);
+        } while (x != 0);
+        size_t head = word_length(words[n - 1], base);
+        if (static_cast<size_t>(last - first) < head + (n - 1) * word.digits) {
+            return nullptr;
+        }
+        char* p = first + head;
+        write_word(p, words[n - 1], p - first, base);
+        for (size_t i = n - 1; i-- > 0;) {
+            p += word.digits;
+            write_word(p, words[i], word.digits, base);
+        }
+        return p;
+    }
+
+    void write_small_fixed(char* last, big_integer x, size_t width) {
+        char* p = last;
+        while (x != 0) {
+            write_word(p, divmod_small(x, word.value), word.digits, base);
+            p -= word.digits;
+        }
+        std::fill(last - width, p, '0');
+    }
+
+    big_integer const& power(size_t level) {
+        while (powers.size() <= level) {
+            powers.push_back(powers.empty() ? big_integer(word.value) : powers.back() * powers.back());
+        }
+        return powers[level];
+    }
+
+    big_divisor const& divisor(size_t level) {
+        while (divisors.size() <= level) {
+            divisors.emplace_back(power(divisors.size()));
+        }
+        return divisors[level];
+    }
+
+    int base;
+    radix_word word;
+    bool parallel;
+    std::vector<big_integer> powers;
+    std::vector<big_divisor> divisors;
+};
+
+}
+
+namespace radix_conversion_detail {
+
+// Input joins halves at word^(2^level) for the largest power of the base
+// below 2^32, so that the short pieces are folded in with mul_1.
+class reader {
+public:
+    explicit reader(int base)
+        : base(base)
+        , word(largest_power(base, UINT32_MAX)) {}
+
+    big_integer read(char const* first, char const* last) {
+        size_t len = last - first;
+        if (len <= word.digits * FROM_CHARS_DC_THRESHOLD) {
+            return read_small(first, last);
+        }
+        check_cancelled();
+        size_t level = 0;
+        while ((word.digits << (level + 1)) < len) {
+            level++;
+        }
+        size_t width = word.digits << level;
+        big_integer res = read(first, last - width);
+        res *= power(level);
+        res += read(last - width, last);
+        return res;
+    }
+
+    big_integer read_small(char const* first, char const* last) {
+        size_t head = (last - first) % word.digits;
+        if (head == 0) {
+            head = word.digits;
+        }
+        big_integer res = read_word(first, head, base);
+        for (char const* p = first + head; p != last; p += word.digits) {
+            res *= static_cast<uint32_t>(word.value);
+            res += read_word(p, word.digits, base);
+        }
+        return res;
+    }
+
+    // base^(digits() << level)
+    big_integer const& power(size_t level) {
+        while (powers.size() <= level) {
+            powers.push_back(powers.empty() ? big_integer(word.value) : powers.back() * powers.back());
+        }
+        return powers[level];
+    }
+
+    size_t digits() const {
+        return word.digits;
+    }
+
+private:
+    int base;
+    radix_word word;
+    std::vector<big_integer> powers;
+};
+
+}
+
+using radix_conversion_detail::reader;
+
+size_t chars_needed(big_integer const& a, int base) {
+    check_base(base);
+    size_t bits = bit_length(a);
+    if (bits == 0) {
+        return 1;
+    }
+    if (unsigned b = digit_bits(base)) {
+        return (bits + b - 1) / b + a.sign;
+    }
+    return static_cast<size_t>(bits / std::log2(base)) + 2 + a.sign;
+}
+
+to_chars_result to_chars(char* first, char* last, big_integer const& a, int base) {
+    size_t bound = chars_needed(a, base);
+    size_t room = last - first;
+    unsigned bits = digit_bits(base);
+    // The bound is exact for power-of-two bases and otherwise over by at
+    // most two, plus one for rounding in log2; in between, the writer finds
+    // out whether the digits fit as it goes.
+    if (room < bound && (bits != 0 || room + 3 < bound)) {
+        return {last, std::errc::value_too_large};
+    }
+    char* p = first;
+    if (a.sign) {
+        if (p == last) {
+            return {last, std::errc::value_too_large};
+        }
+        *p++ = '-';
+    }
+    if (bits != 0) {
+        return {write_pow2(p, a, bits), std::errc()};
+    }
+    big_integer x = a;
+    x.sign = false;
+    char* end = writer(base).write(p, last, x);
+    if (!end) {
+        return {last, std::errc::value_too_large};
+    }
+    return {end, std::errc()};
+}
+
+from_chars_result from_chars(char const* first, char const* last, big_integer& value, int base) {
+    check_base(base);
+    char const* p = first;
+    bool negative = p != last && *p == '-';
+    if (negative) {
+        p++;
+    }
+    char const* digits = p;
+    p = digits_end(p, last, base);
+    if (p == digits) {
+        return {first, std::errc::invalid_argument};
+    }
+    unsigned bits = digit_bits(base);
+    value = bits != 0 ? read_pow2(digits, p, bits) : reader(base).read(digits, p);
+    value.sign = negative && value != 0;
+    return {p, std::errc()};
+}
+
+from_chars_result parallel_from_chars(char const* first, char const* last, big_integer& value, int base,
+                                      unsigned threads) {
+    check_base(base);
+    if (threads == 0) {
+        threads = shared_pool().threads();
+    }
+    char const* digits = first != last && *first == '-' ? first + 1 : first;
+    char const* end = digits_end(digits, last, base);
+    reader powers(base);
+    size_t len = end - digits, piece_level = 0;
+    if (threads == 1 || digit_bits(base) != 0 || len < (powers.digits() * FROM_CHARS_DC_THRESHOLD << 2) * threads) {
+        return from_chars(first, last, value, base);
+    }
+    // Pieces of digits << piece_level digits from the right, at least four
+    // per thread to even out the load, and the top piece holds the rest.
+    while ((powers.digits() << (piece_level + 1)) * threads * 4 <= len) {
+        piece_level++;
+    }
+    size_t width = powers.digits() << piece_level;
+    size_t count = (len + width - 1) / width, levels = 0;
+    while ((size_t(1) << levels) < count) {
+        levels++;
+    }
+    // Task 0 squares up the powers for the joins while the others convert.
+    std::vector<big_integer> pieces(count);
+    parallel_for(count + 1, threads, [&](size_t i) {
+        if (i == 0) {
+            if (levels != 0) {
+                powers.power(piece_level + levels - 1);
+            }
+            return;
+        }
+        char const* piece_last = end - (i - 1) * width;
+        pieces[i - 1] = reader(base).read(std::max(digits, piece_last - width), piece_last);
+    });
+    for (size_t level = 0; level < levels; level++) {
+        big_integer const& power = powers.power(piece_level + level);
+        size_t pairs = pieces.size() / 2;
+        parallel_for(pairs, threads, [&](size_t i) {
+            big_integer& hi = pieces[2 * i + 1];
+            hi *= power;
+            hi += pieces[2 * i];
+        });
+        for (size_t i = 0; i < pairs; i++) {
+            std::swap(pieces[i], pieces[2 * i + 1]);
+        }
+        if (pieces.size() % 2 == 1) {
+            std::swap(pieces[pairs], pieces.back());
+        }
+        pieces.resize((pieces.size() + 1) / 2);
+    }
+    value = std::move(pieces[0]);
+    value.sign = digits != first && value != 0;
+    return {end, std::errc()};
+}
+
+incremental_parser::incremental_parser(int base)
+    : base(base)
+    , negative(false)
+    , started(false)
+    , stopped(false)
+    , digits_seen(false) {
+    check_base(base);
+    convert.reset(new reader(base));
+    block_size = convert->digits() << PARSER_BLOCK_LEVEL;
+    pending.reserve(block_size);
+}
+
+incremental_parser::~incremental_parser() = default;
+
+bool incremental_parser::feed(char c) {
+    if (stopped) {
+        return false;
+    }
+    bool first = !started;
+    started = true;
+    if (first && c == '-') {
+        negative = true;
+        return true;
+    }
+    if (digit_value(c) >= static_cast<uint32_t>(base)) {
+        stopped = true;
+        return false;
+    }
+    digits_seen = true;
+    pending.push_back(c);
+    if (pending.size() == block_size) {
+        flush();
+    }
+    return true;
+}
+
+char const* incremental_parser::feed(char const* first, char const* last) {
+    char const* p = first;
+    while (p != last && feed(*p)) {
+        p++;
+    }
+    return p;
+}
+
+bool incremental_parser::has_digits() const {
+    return digits_seen;
+}
+
+void incremental_parser::flush() {
+    blocks.emplace_back(convert->read(pending.data(), pending.data() + pending.size()), 0);
+    pending.clear();
+    while (blocks.size() >= 2 && blocks[blocks.size() - 2].second == blocks.back().second) {
+        std::pair<big_integer, size_t> lo = std::move(blocks.back());
+        blocks.pop_back();
+        std::pair<big_integer, size_t>& hi = blocks.back();
+        hi.first *= convert->power(lo.second + PARSER_BLOCK_LEVEL);
+        hi.first += lo.first;
+        hi.second++;
+    }
+}
+
+big_integer incremental_parser::finish() {
+    if (!digits_seen) {
+        throw std::invalid_argument("invalid number");
+    }
+    // The blocks left have distinct levels, decreasing towards the end, so
+    // they are joined from the least significant with a running power.
+    big_integer res = pending.empty() ? big_integer() : convert->read(pending.data(), pending.data() + pending.size());
+    big_integer scale = pow(big_integer(base), pending.size());
+    for (size_t i = blocks.size(); i-- > 0;) {
+        big_integer const& block = blocks[i].first;
+        res += block * scale;
+        if (i > 0) {
+            scale *= convert->power(blocks[i].second + PARSER_BLOCK_LEVEL);
+        }
+    }
+    res.sign = negative && res != 0;
+    return res;
+}
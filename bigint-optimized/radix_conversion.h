@@ -0,0 +1,97 @@
+#ifndef BIGINT_RADIX_CONVERSION_H
+#define BIGINT_RADIX_CONVERSION_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "big_integer.h"
+
+// Text conversion in bases 2 to 36 into and out of caller-provided memory,
+// with the conventions of std::to_chars and std::from_chars: lowercase
+// digits, an optional leading '-', no prefix, no terminating zero.
+struct to_chars_result {
+    char* ptr;
+    std::errc ec;
+};
+
+struct from_chars_result {
+    char const* ptr;
+    std::errc ec;
+};
+
+// Upper bound on the characters to_chars writes for a, sign included; exact
+// for power-of-two bases.
+size_t chars_needed(big_integer const& a, int base = 10);
+
+// Writes a into [first, last). On success ptr is one past the last character
+// written; if the buffer is too small it returns {last, value_too_large}.
+// Power-of-two bases take the digits straight from the bits of the limbs.
+// Other large values are split by repeated squares of the base and written
+// half by half, so most of the work is in big_divisor rather than short
+// division. When the shared pool has more than one thread, the halves of
+// large pieces are written concurrently into their parts of the buffer.
+to_chars_result to_chars(char* first, char* last, big_integer const& a, int base = 10);
+
+// Parses the longest prefix of [first, last) that is a number in the base.
+// On success ptr is one past it and value is set; if there are no digits it
+// returns {first, invalid_argument} and leaves value alone. Long inputs are
+// parsed as two halves joined by one Karatsuba product.
+from_chars_result from_chars(char const* first, char const* last, big_integer& value, int base = 10);
+
+// from_chars on several threads, 0 meaning the width of the shared pool.
+// Runs of digits are converted in parallel and joined pairwise, level by
+// level, by the powers of the base, which are squared up meanwhile.
+// Deterministic: the result does not depend on the number of threads.
+from_chars_result parallel_from_chars(char const* first, char const* last, big_integer& value, int base = 10,
+                                      unsigned threads = 0);
+
+namespace radix_conversion_detail {
+class reader;
+}
+
+// Parses a number that arrives in pieces, with the syntax of from_chars,
+// keeping at most one block of unconverted digits. Full blocks are joined
+// like a binary counter, two of equal length at a time, so the products are
+// balanced as in from_chars.
+class incremental_parser {
+public:
+    explicit incremental_parser(int base = 10);
+    ~incremental_parser();
+
+    incremental_parser(incremental_parser const&) = delete;
+    incremental_parser& operator=(incremental_parser const&) = delete;
+
+    // Takes the next character, returning false once it cannot continue the
+    // number; it and everything after are then left to the caller.
+    bool feed(char c);
+
+    // Takes the next piece of input and returns one past the part of it that
+    // continues the number.
+    char const* feed(char const* first, char const* last);
+
+    bool has_digits() const;
+
+    // The number read so far. Throws std::invalid_argument if there were no
+    // digits.
+    big_integer finish();
+
+private:
+    void flush();
+
+    int base;
+    bool negative;
+    bool started;
+    bool stopped;
+    bool digits_seen;
+    std::string pending;
+    size_t block_size;
+    // Full blocks from the most significant; a block of level l holds
+    // block_size << l digits.
+    std::vector<std::pair<big_integer, size_t>> blocks;
+    std::unique_ptr<radix_conversion_detail::reader> convert;
+};
+
+#endif //BIGINT_RADIX_CONVERSION_H
@@ -4,36 +4,69 @@
 
 shared_vector::shared_vector()
     : counter(1)
-    , data({0}) {}
+    , data({0})
+    , view(nullptr)
+    , view_size(0) {}
 
 shared_vector::shared_vector(std::vector<uint32_t> x)
     : counter(1)
-    , data(std::move(x)) {}
+    , data(std::move(x))
+    , view(nullptr)
+    , view_size(0) {}
+
+shared_vector::shared_vector(uint32_t const* view, size_t n, std::shared_ptr<void const> owner)
+    : counter(1)
+    , view(view)
+    , view_size(n)
+    , owner(std::move(owner)) {}
 
 size_t shared_vector::size() const {
-    return data.size();
+    return view ? view_size : data.size();
 }
 
 uint32_t & shared_vector::back() {
+    detach();
     return data.back();
 }
 
 void shared_vector::pop_back() {
+    detach();
     data.pop_back();
 }
 
 void shared_vector::push_back(uint32_t x) {
+    detach();
     data.push_back(x);
 }
 
 void shared_vector::resize(size_t x) {
+    detach();
     data.resize(x);
 }
 
 uint32_t const& shared_vector::operator[](size_t x) const {
-    return data[x];
+    return view ? view[x] : data[x];
 }
 
 uint32_t& shared_vector::operator[](size_t x) {
+    detach();
     return data[x];
 }
+
+uint32_t const* shared_vector::begin() const {
+    return view ? view : data.data();
+}
+
+uint32_t* shared_vector::begin() {
+    detach();
+    return data.data();
+}
+
+void shared_vector::detach() {
+    if (view) {
+        data.assign(view, view + view_size);
+        view = nullptr;
+        view_size = 0;
+        owner.reset();
+    }
+}
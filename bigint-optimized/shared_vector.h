@@ -3,12 +3,17 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 struct shared_vector {
 public:
     shared_vector();
     explicit shared_vector(std::vector<uint32_t>);
+    // Wraps n limbs that live elsewhere without copying them. Reads go to the
+    // external array; the first write copies it into data. owner is held
+    // until then, so it can keep the memory alive.
+    shared_vector(uint32_t const* view, size_t n, std::shared_ptr<void const> owner);
 
     size_t size() const;
     uint32_t& back();
@@ -17,12 +22,21 @@ public:
     void resize(size_t);
     uint32_t const& operator[](size_t x) const;
     uint32_t& operator[](size_t x);
+    uint32_t const* begin() const;
+    uint32_t* begin();
     friend bool operator==(shared_vector const& a, shared_vector const& b) {
-        return a.data == b.data;
+        return a.size() == b.size() && std::equal(a.begin(), a.begin() + a.size(), b.begin());
     }
 
     size_t counter;
     std::vector<uint32_t> data;
+
+private:
+    void detach();
+
+    uint32_t const* view;
+    size_t view_size;
+    std::shared_ptr<void const> owner;
 };
 
 #endif //BIGINT_SHARED_VECTOR_H
@@ -16,6 +16,19 @@ shared_vector_small_object::shared_vector_small_object(std::vector<uint32_t> x){
     }
 }
 
+shared_vector_small_object::shared_vector_small_object(uint32_t x)
+    : is_small(true)
+    , small_size(1) {
+    small[0] = x;
+}
+
+shared_vector_small_object::shared_vector_small_object(uint32_t const* view, size_t n,
+                                                       std::shared_ptr<void const> owner)
+    : is_small(false)
+    , small_size(0) {
+    num = new shared_vector(view, n, std::move(owner));
+}
+
 shared_vector_small_object::shared_vector_small_object(shared_vector_small_object const& other) {
     is_small = other.is_small;
     if (other.is_small) {
@@ -79,10 +92,10 @@ void shared_vector_small_object::push_back(uint32_t x) {
 
 void shared_vector_small_object::resize(size_t x) {
     if (is_small && x <= SIZE) {
-        small_size = x;
         if (small_size < x) {
             std::fill(small + small_size, small + x, 0);
         }
+        small_size = x;
     } else {
         to_big();
         check_counter();
@@ -94,7 +107,7 @@ uint32_t const& shared_vector_small_object::operator[](size_t x) const {
     if (is_small) {
         return small[x];
     } else {
-        return (*num)[x];
+        return shared()[x];
     }
 }
 
@@ -107,25 +120,32 @@ uint32_t& shared_vector_small_object::operator[](size_t x) {
     }
 }
 
-bool operator==(shared_vector_small_object const &a, shared_vector_small_object const &b) {
-    if (a.size() == b.size()) {
-        if (a.is_small && b.is_small) {
-            return std::equal(a.small, a.small + a.small_size, b.small);
-        } else if (a.is_small && !b.is_small) {
-            return std::equal(a.small, a.small + a.small_size, b.num->data.begin());
-        } else if (!a.is_small && b.is_small) {
-            return b == a;
-        } else {
-            return a.num->data == b.num->data;
-        }
+uint32_t const* shared_vector_small_object::data() const {
+    if (is_small) {
+        return small;
+    } else {
+        return shared().begin();
     }
-    return false;
+}
+
+uint32_t* shared_vector_small_object::data() {
+    if (is_small) {
+        return small;
+    } else {
+        check_counter();
+        return num->begin();
+    }
+}
+
+bool operator==(shared_vector_small_object const &a, shared_vector_small_object const &b) {
+    return a.size() == b.size() && std::equal(a.data(), a.data() + a.size(), b.data());
 }
 
 void shared_vector_small_object::check_counter() {
     if (num->counter > 1) {
         num->counter--;
-        num = new shared_vector(num->data);
+        uint32_t const* limbs = shared().begin();
+        num = new shared_vector(std::vector<uint32_t>(limbs, limbs + size()));
     }
 }
 
@@ -146,6 +166,12 @@ shared_vector_small_object& shared_vector_small_object::operator=(shared_vector_
     return *this;
 }
 
+// Reads must not go through num directly, which would pick the non-const
+// overloads and copy a view.
+shared_vector const& shared_vector_small_object::shared() const {
+    return *num;
+}
+
 void shared_vector_small_object::to_big() {
     if (is_small) {
         num = new shared_vector(std::vector<uint32_t>(small, small + small_size));
@@ -15,9 +15,12 @@ private:
     void delete_num();
     void check_counter();
     void to_big();
+    shared_vector const& shared() const;
 
 public:
     explicit shared_vector_small_object(std::vector<uint32_t>);
+    explicit shared_vector_small_object(uint32_t);
+    shared_vector_small_object(uint32_t const* view, size_t n, std::shared_ptr<void const> owner);
     shared_vector_small_object(shared_vector_small_object const&);
     ~shared_vector_small_object();
 
@@ -28,6 +31,8 @@ public:
     void resize(size_t);
     uint32_t const& operator[](size_t x) const;
     uint32_t& operator[](size_t x);
+    uint32_t const* data() const;
+    uint32_t* data();
     friend bool operator==(shared_vector_small_object const &a,
             shared_vector_small_object const &b);
     shared_vector_small_object& operator=(shared_vector_small_object const& other);